@@ -0,0 +1,105 @@
+// Compares building the rows of a parsed CSV file with a monotonic arena, as
+// `rapidcsv::Document::LoadMapped` does, and with the default allocator.
+// Build and run from the top directory with
+//
+//     g++ -std=c++20 -O2 -o arena benchmarks/arena.cpp
+//     ./arena [ROWS]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Returns an events file with `rowCount` rows. Every tenth description has an escaped quote,
+// so that its cell has to be copied, like cells with escaped quotes are when parsing.
+std::string makeEvents(std::size_t rowCount) {
+    std::string text{"date,category,description\n"};
+    for (std::size_t i{0}; i < rowCount; i++) {
+        text += "2023-05-17,work,";
+        text += i % 10 == 0 ? "\"Meeting with \"\"the\"\" team\"" : "Meeting with the team";
+        text += ' ';
+        text += std::to_string(i);
+        text += '\n';
+    }
+    return text;
+}
+
+// Splits `text` into rows of cells allocated from `resource`, the way the mapped Document
+// keeps them: a vector of views for each row, and copies of the cells with escaped quotes.
+// Returns the number of cells, so that the work can't be optimized away.
+std::size_t parseRows(std::string_view text, std::pmr::memory_resource* resource) {
+    std::vector<std::pmr::vector<std::string_view>> rows;
+    std::pmr::vector<std::string_view> row{resource};
+    std::vector<std::string_view> copies;
+    std::size_t cellCount{0};
+    while (!text.empty()) {
+        const auto lineEnd = std::min(text.find('\n'), text.size());
+        std::string_view line{text.substr(0, lineEnd)};
+        text.remove_prefix(std::min(lineEnd + 1, text.size()));
+
+        row.clear();
+        while (true) {
+            const auto cellEnd = std::min(line.find(','), line.size());
+            std::string_view cell{line.substr(0, cellEnd)};
+            if (cell.find('"') != std::string_view::npos) {
+                char* copy = static_cast<char*>(resource->allocate(cell.size(), 1));
+                copies.emplace_back(copy, cell.size());
+                const auto end = std::remove_copy(cell.begin(), cell.end(), copy, '"');
+                cell = std::string_view{copy, static_cast<std::size_t>(end - copy)};
+            }
+            row.push_back(cell);
+            if (cellEnd == line.size()) {
+                break;
+            }
+            line.remove_prefix(cellEnd + 1);
+        }
+        cellCount += row.size();
+        rows.emplace_back(row.begin(), row.end(), resource);
+    }
+
+    // Give the copies back one by one, like strings owned by the rows would be.
+    // A monotonic arena ignores this and frees everything when it is destroyed.
+    for (const auto copy : copies) {
+        resource->deallocate(const_cast<char*>(copy.data()), copy.size(), 1);
+    }
+    return cellCount;
+}
+
+// Returns the median time of `runs` calls of `f`, in milliseconds.
+template <typename F>
+double timeMedian(F f, int runs) {
+    std::vector<double> times;
+    for (int i{0}; i < runs; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t rowCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    const auto text = makeEvents(rowCount);
+    constexpr int runs = 9;
+
+    std::size_t cells{0};
+    const auto defaultTime = timeMedian([&] { cells = parseRows(text, std::pmr::new_delete_resource()); }, runs);
+    const auto arenaTime = timeMedian([&] {
+        std::pmr::monotonic_buffer_resource arena{text.size(), std::pmr::new_delete_resource()};
+        cells = parseRows(text, &arena);
+    }, runs);
+
+    std::cout << rowCount << " rows, " << cells << " cells, median of " << runs << " runs\n"
+        << "default allocator: " << defaultTime << " ms\n"
+        << "monotonic arena:   " << arenaTime << " ms\n";
+}
@@ -0,0 +1,83 @@
+// Compares rapidcsv's flat hash index for row and column names with the
+// std::map it replaced, on the row names of a file with many rows.
+// Build and run from the top directory with
+//
+//     g++ -std=c++20 -O2 -o namelookup benchmarks/namelookup.cpp
+//     ./namelookup [ROWS]
+//
+// The default of 10 million rows needs a few gigabytes of memory.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../rapidcsv.h"
+
+namespace {
+
+// Returns the milliseconds taken by `f`.
+template <typename F>
+double timeMilliseconds(F f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(std::string_view name, double buildTime, double lookupTime, std::size_t found) {
+    std::cout << name << ": built in " << buildTime << " ms, looked up all names in "
+        << lookupTime << " ms (" << found << " found)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t rowCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+
+    // Row names like the first column of an events file with row labels.
+    std::vector<std::string> names;
+    names.reserve(rowCount);
+    for (std::size_t i{0}; i < rowCount; i++) {
+        names.push_back("event-" + std::to_string(i * 7919 % rowCount));
+    }
+    std::vector<std::string> lookups{names};
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937{42});
+
+    std::cout << rowCount << " row names\n";
+    {
+        std::map<std::string, std::size_t> map;
+        const auto buildTime = timeMilliseconds([&] {
+            for (std::size_t i{0}; i < names.size(); i++) {
+                map[names[i]] = i;
+            }
+        });
+        std::size_t found{0};
+        const auto lookupTime = timeMilliseconds([&] {
+            for (const auto& name : lookups) {
+                found += map.find(name) != map.end();
+            }
+        });
+        report("std::map             ", buildTime, lookupTime, found);
+    }
+    {
+        rapidcsv::NameIndex index;
+        const auto buildTime = timeMilliseconds([&] {
+            index.Reserve(names.size());
+            for (std::size_t i{0}; i < names.size(); i++) {
+                index.Assign(names[i], i);
+            }
+        });
+        std::size_t found{0};
+        const auto lookupTime = timeMilliseconds([&] {
+            for (const auto& name : lookups) {
+                found += index.Find(name) >= 0;
+            }
+        });
+        report("rapidcsv::NameIndex  ", buildTime, lookupTime, found);
+    }
+}
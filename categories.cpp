@@ -0,0 +1,24 @@
+#include "categories.h"
+
+CategoryId CategoryTable::intern(std::string_view name) {
+    if (auto it = lookup.find(name); it != lookup.end()) {
+        return it->second;
+    }
+
+    const auto id = static_cast<CategoryId>(names.size());
+    names.emplace_back(name);
+    lookup.emplace(names.back(), id);
+    return id;
+}
+
+std::optional<CategoryId> CategoryTable::find(std::string_view name) const {
+    if (auto it = lookup.find(name); it != lookup.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+CategoryTable& getCategoryTable() {
+    static CategoryTable table;
+    return table;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Small integer id standing in for a category name.
+using CategoryId = std::uint32_t;
+
+// Interns category names, so that each distinct name is stored only once
+// and events can refer to it by a small id. Ids are handed out in order
+// of first appearance, starting from zero.
+class CategoryTable {
+public:
+    // Returns the id of `name`, adding it to the table if it is new.
+    CategoryId intern(std::string_view name);
+
+    // Returns the id of `name` if it has been interned, otherwise `std::nullopt`.
+    std::optional<CategoryId> find(std::string_view name) const;
+
+    // Returns the name for `id`, which must have come from this table.
+    const std::string& getName(CategoryId id) const { return names[id]; }
+
+    // Returns the number of distinct categories.
+    std::size_t size() const { return names.size(); }
+
+private:
+    // A deque keeps its elements in place as it grows, so the lookup keys can view into it.
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, CategoryId> lookup;
+};
+
+// Returns the table shared by all events in the program.
+CategoryTable& getCategoryTable();
@@ -0,0 +1,123 @@
+#include "dateindex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+DateIndex::DateIndex(const EventStore& events) {
+    if (events.size() > std::numeric_limits<EventIndex>::max()) {
+        throw std::length_error("too many events to index");
+    }
+
+    const auto eventDays = events.getDayNumbers();
+    order.resize(eventDays.size());
+    std::iota(order.begin(), order.end(), EventIndex{0});
+    std::stable_sort(order.begin(), order.end(),
+        [eventDays](EventIndex a, EventIndex b) { return eventDays[a] < eventDays[b]; });
+
+    days.reserve(order.size());
+    for (auto i : order) {
+        days.push_back(eventDays[i]);
+    }
+}
+
+std::span<const DateIndex::EventIndex> DateIndex::range(std::chrono::sys_days first, std::chrono::sys_days last) const {
+    if (last < first) {
+        return {};
+    }
+    const auto begin = std::lower_bound(days.begin(), days.end(), first.time_since_epoch().count());
+    const auto end = std::upper_bound(begin, days.end(), last.time_since_epoch().count());
+    return std::span<const EventIndex>{order}.subspan(
+        static_cast<std::size_t>(begin - days.begin()),
+        static_cast<std::size_t>(end - begin));
+}
+
+std::optional<DateIndex::EventIndex> DateIndex::nearest(std::chrono::sys_days day) const {
+    if (days.empty()) {
+        return std::nullopt;
+    }
+
+    const auto target = day.time_since_epoch().count();
+    const auto after = std::lower_bound(days.begin(), days.end(), target);
+    if (after == days.begin()) {
+        return order.front();
+    }
+
+    // Of the events on the closest earlier date, the first one in the store wins,
+    // like it does on any other date.
+    const auto before = std::lower_bound(days.begin(), after, *(after - 1));
+    const auto pick = (after == days.end() || target - *before < *after - target) ? before : after;
+    return order[static_cast<std::size_t>(pick - days.begin())];
+}
+
+AnniversaryIndex::AnniversaryIndex(const EventStore& events) : starts(bucketCount + 1, 0) {
+    if (events.size() > std::numeric_limits<EventIndex>::max()) {
+        throw std::length_error("too many events to index");
+    }
+
+    // Counting sort into the buckets, keeping the store order within each bucket.
+    std::vector<std::uint16_t> buckets;
+    buckets.reserve(events.size());
+    for (const auto day : events.getDayNumbers()) {
+        const std::chrono::year_month_day date{std::chrono::sys_days{std::chrono::days{day}}};
+        buckets.push_back(static_cast<std::uint16_t>(getBucket(date.month() / date.day())));
+    }
+    for (const auto bucket : buckets) {
+        starts[bucket + 1]++;
+    }
+    for (std::size_t b{1}; b <= bucketCount; b++) {
+        starts[b] += starts[b - 1];
+    }
+
+    indexes.resize(events.size());
+    auto next = starts;
+    for (EventIndex i{0}; i < buckets.size(); i++) {
+        indexes[next[buckets[i]]++] = i;
+    }
+
+    // Both buckets are in store order, so merging them keeps it.
+    const auto february28 = getBucket(std::chrono::February / std::chrono::day{28});
+    const auto begin = indexes.begin();
+    std::merge(begin + starts[february28], begin + starts[february28 + 1],
+               begin + starts[february28 + 1], begin + starts[february28 + 2],
+               std::back_inserter(leapDayMerged));
+}
+
+std::span<const AnniversaryIndex::EventIndex> AnniversaryIndex::onThisDay(const std::chrono::year_month_day& date) const {
+    using namespace std::chrono;
+
+    if (!date.year().is_leap() && date.month() == February && date.day() == day{28}) {
+        return leapDayMerged;
+    }
+    const auto bucket = getBucket(date.month() / date.day());
+    return std::span<const EventIndex>{indexes}.subspan(starts[bucket], starts[bucket + 1] - starts[bucket]);
+}
+
+std::size_t AnniversaryIndex::getBucket(const std::chrono::month_day& monthDay) {
+    // Days before the first of each month in a leap year.
+    static constexpr std::uint16_t daysBefore[12] = {
+        0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335
+    };
+    return daysBefore[static_cast<unsigned>(monthDay.month()) - 1] + static_cast<unsigned>(monthDay.day()) - 1;
+}
+
+const DateIndex& EventIndexes::byDate() {
+    if (!dateIndex.has_value()) {
+        dateIndex.emplace(events);
+    }
+    return dateIndex.value();
+}
+
+const AnniversaryIndex& EventIndexes::byAnniversary() {
+    if (!anniversaryIndex.has_value()) {
+        anniversaryIndex.emplace(events);
+    }
+    return anniversaryIndex.value();
+}
+
+void EventIndexes::reset() {
+    dateIndex.reset();
+    anniversaryIndex.reset();
+}
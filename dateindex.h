@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "eventstore.h"
+
+// Events of an `EventStore` ordered by date, for answering date range
+// and nearest-event queries with binary searches instead of full scans.
+// Events on the same date keep their order from the store.
+class DateIndex {
+public:
+    using EventIndex = std::uint32_t;
+
+    explicit DateIndex(const EventStore& events);
+
+    // Returns the indexes of the events from `first` to `last`, inclusive, in date order.
+    std::span<const EventIndex> range(std::chrono::sys_days first, std::chrono::sys_days last) const;
+
+    // Returns the index of the event closest to `day`, or `std::nullopt` if there are no events.
+    // Of two dates equally far away, the upcoming one wins, and of several events
+    // on the closest date, the first one in the store.
+    std::optional<EventIndex> nearest(std::chrono::sys_days day) const;
+
+    // Returns all event indexes in date order.
+    std::span<const EventIndex> all() const { return order; }
+
+    std::size_t size() const { return order.size(); }
+
+private:
+    std::vector<EventStore::DayNumber> days;  // sorted; days[i] is the date of event order[i]
+    std::vector<EventIndex> order;
+};
+
+// Events of an `EventStore` grouped by their month and day, regardless of year,
+// for "on this day" queries. There is one bucket for every day of a leap year.
+class AnniversaryIndex {
+public:
+    using EventIndex = std::uint32_t;
+
+    explicit AnniversaryIndex(const EventStore& events);
+
+    // Returns the indexes of the events that happened on `date`'s month and day in any year,
+    // in the order they are in the store. In years without a February 29th, the events
+    // on February 29th are included on February 28th.
+    std::span<const EventIndex> onThisDay(const std::chrono::year_month_day& date) const;
+
+private:
+    static constexpr std::size_t bucketCount = 366;
+
+    // Returns the bucket for `monthDay`, with January 1st in bucket 0 and February 29th in bucket 59.
+    static std::size_t getBucket(const std::chrono::month_day& monthDay);
+
+    std::vector<EventIndex> starts;  // bucket b is [starts[b], starts[b + 1]) in `indexes`
+    std::vector<EventIndex> indexes;
+    std::vector<EventIndex> leapDayMerged;  // February 28th and 29th together, for years without a 29th
+};
+
+// The indexes of an `EventStore`, each built the first time it is needed and then
+// kept, so that a long-running program can answer many queries with them.
+// Call `reset` whenever the events change.
+class EventIndexes {
+public:
+    explicit EventIndexes(const EventStore& events) : events(events) { }
+
+    const DateIndex& byDate();
+    const AnniversaryIndex& byAnniversary();
+
+    void reset();
+
+private:
+    const EventStore& events;
+    std::optional<DateIndex> dateIndex;
+    std::optional<AnniversaryIndex> anniversaryIndex;
+};
@@ -0,0 +1,227 @@
+#include "dates.h"
+
+#include <algorithm>  // for std::min and std::count_if
+#include <cstdint>  // for std::uint16_t
+#include <cstring>  // for std::memcpy
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>  // for SSE2 intrinsics
+#define DAYS_HAVE_SSE2 1
+#endif
+
+namespace {
+
+// Make sure the formatter and the digit pair table agree with each other.
+constexpr bool formatsAs(std::chrono::year_month_day date, std::string_view expected) {
+    char text[isoDateLength]{};
+    formatIsoDate(date, text);
+    return std::string_view{text, isoDateLength} == expected;
+}
+static_assert(formatsAs(std::chrono::year{2023} / 1 / 9, "2023-01-09"));
+static_assert(formatsAs(std::chrono::year{987} / 12 / 31, "0987-12-31"));
+
+constexpr bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Combines already validated digits into a date and checks it against the calendar.
+DateParseResult makeDate(int year, unsigned month, unsigned day) noexcept {
+    const std::chrono::year_month_day date{
+        std::chrono::year{year},
+        std::chrono::month{month},
+        std::chrono::day{day}};
+    if (!date.ok()) {
+        return {date, DateError::InvalidDate};
+    }
+    return {date, DateError::None};
+}
+
+constexpr bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Returns `true` if `text` has the plain YYYY-MM-DD layout: digits, with dashes at offsets 4 and 7.
+bool hasPlainLayout(std::string_view text) noexcept {
+    if (text.size() != isoDateLength || text[4] != '-' || text[7] != '-') {
+        return false;
+    }
+    for (std::size_t i{0}; i < isoDateLength; i++) {
+        if (i != 4 && i != 7 && !isDigit(text[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Converts the number at the start of `part` like `std::stoi` does: leading whitespace
+// and a plus sign are skipped, and anything after the digits is ignored.
+// Returns -1 if there are no digits. Parts are at most 8 characters long, so never overflow.
+int parseLooseNumber(std::string_view part) noexcept {
+    std::size_t i{0};
+    while (i < part.size() && isSpace(part[i])) {
+        i++;
+    }
+    if (i < part.size() && part[i] == '+') {
+        i++;
+    }
+    if (i == part.size() || !isDigit(part[i])) {
+        return -1;
+    }
+    int value{0};
+    for (; i < part.size() && isDigit(part[i]); i++) {
+        value = value * 10 + (part[i] - '0');
+    }
+    return value;
+}
+
+// Parses a 10-character date that does not have the plain layout the way the original
+// `getDateFromString` did: split at dashes with `std::getline`, and each part converted
+// with `std::stoul` or `std::stoi`. Events files written for it may hold dates like
+// `2020-01-1x` or `2020-1-01 `, and those must keep meaning what they meant.
+DateParseResult parseLooseDate(std::string_view text) noexcept {
+    const std::chrono::year_month_day none{};
+
+    // Like `std::getline`, a dash at the very end does not start another part.
+    std::string_view parts[3];
+    std::size_t count{0};
+    for (std::size_t start{0}; start < text.size();) {
+        if (count == 3) {
+            return {none, DateError::BadSeparator};
+        }
+        const auto dash = std::min(text.find('-', start), text.size());
+        parts[count++] = text.substr(start, dash - start);
+        start = dash + 1;
+    }
+    if (count != 3) {
+        return {none, DateError::BadSeparator};
+    }
+
+    const int year = parseLooseNumber(parts[0]);
+    const int month = parseLooseNumber(parts[1]);
+    const int day = parseLooseNumber(parts[2]);
+    if (year < 0 || month < 0 || day < 0) {
+        return {none, DateError::NotADigit};
+    }
+    return makeDate(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+}
+
+#ifdef DAYS_HAVE_SSE2
+// How many dates `parseIsoDateBlock` parses at once, one per byte of a register.
+constexpr std::size_t dateBlockSize = 16;
+
+// Transposes the 16x16 byte matrix held in `rows`: four rounds of interleaving
+// each row of the top half with the matching row of the bottom half.
+void transposeBlock(__m128i (&rows)[dateBlockSize]) noexcept {
+    for (int round{0}; round < 4; round++) {
+        __m128i interleaved[dateBlockSize];
+        for (std::size_t i{0}; i < dateBlockSize / 2; i++) {
+            interleaved[2 * i] = _mm_unpacklo_epi8(rows[i], rows[i + dateBlockSize / 2]);
+            interleaved[2 * i + 1] = _mm_unpackhi_epi8(rows[i], rows[i + dateBlockSize / 2]);
+        }
+        std::memcpy(rows, interleaved, sizeof interleaved);
+    }
+}
+
+// Parses up to `dateBlockSize` dates at once. Each date goes into one row of a 16x16 byte
+// block, which is transposed so that every register holds one position of all the dates.
+// The layout is then checked and the digits are combined for all dates with a few vector
+// operations, and only the calendar check is left for each date. Dates without the plain
+// layout go through `parseIsoDate`, so the results are always the same as with it.
+void parseIsoDateBlock(const std::string_view* texts, std::size_t count, DateParseResult* results) noexcept {
+    alignas(16) unsigned char block[dateBlockSize][16] = {};
+    unsigned candidates{0};
+    for (std::size_t i{0}; i < count; i++) {
+        if (texts[i].size() == isoDateLength) {
+            std::memcpy(block[i], texts[i].data(), isoDateLength);
+            candidates |= 1u << i;
+        }
+    }
+
+    __m128i positions[dateBlockSize];
+    for (std::size_t i{0}; i < dateBlockSize; i++) {
+        positions[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(block[i]));
+    }
+    transposeBlock(positions);
+
+    // Digits where expected and dashes at offsets 4 and 7, one mask bit per date.
+    const __m128i dash = _mm_set1_epi8('-');
+    const __m128i nine = _mm_set1_epi8(9);
+    __m128i plain = _mm_and_si128(_mm_cmpeq_epi8(positions[4], dash), _mm_cmpeq_epi8(positions[7], dash));
+    for (const std::size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        positions[i] = _mm_sub_epi8(positions[i], _mm_set1_epi8('0'));
+        plain = _mm_and_si128(plain, _mm_cmpeq_epi8(_mm_max_epu8(positions[i], nine), nine));
+    }
+    const unsigned plainDates = static_cast<unsigned>(_mm_movemask_epi8(plain)) & candidates;
+
+    // Combine the digits in 16-bit lanes, eight dates at a time.
+    alignas(16) std::uint16_t years[dateBlockSize];
+    alignas(16) std::uint16_t months[dateBlockSize];
+    alignas(16) std::uint16_t days[dateBlockSize];
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ten = _mm_set1_epi16(10);
+    for (std::size_t half{0}; half < 2; half++) {
+        auto digit = [&](std::size_t i) {
+            return half == 0 ? _mm_unpacklo_epi8(positions[i], zero) : _mm_unpackhi_epi8(positions[i], zero);
+        };
+        auto combine = [&ten](__m128i high, __m128i low) {
+            return _mm_add_epi16(_mm_mullo_epi16(high, ten), low);
+        };
+        const __m128i year = combine(combine(combine(digit(0), digit(1)), digit(2)), digit(3));
+        _mm_store_si128(reinterpret_cast<__m128i*>(years + half * 8), year);
+        _mm_store_si128(reinterpret_cast<__m128i*>(months + half * 8), combine(digit(5), digit(6)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(days + half * 8), combine(digit(8), digit(9)));
+    }
+
+    for (std::size_t i{0}; i < count; i++) {
+        results[i] = (plainDates >> i & 1) != 0 ? makeDate(years[i], months[i], days[i]) : parseIsoDate(texts[i]);
+    }
+}
+#endif
+
+}  // namespace
+
+DateParseResult parseIsoDate(std::string_view text) noexcept {
+    if (text.size() != isoDateLength) {
+        return {std::chrono::year_month_day{}, DateError::WrongLength};
+    }
+    if (!hasPlainLayout(text)) {
+        return parseLooseDate(text);
+    }
+
+    auto digit = [text](std::size_t i) { return text[i] - '0'; };
+    return makeDate(
+        digit(0) * 1000 + digit(1) * 100 + digit(2) * 10 + digit(3),
+        static_cast<unsigned>(digit(5) * 10 + digit(6)),
+        static_cast<unsigned>(digit(8) * 10 + digit(9)));
+}
+
+std::size_t parseIsoDates(const std::string_view* texts, std::size_t count,
+                          DateParseResult* results) noexcept {
+#ifdef DAYS_HAVE_SSE2
+    for (std::size_t i{0}; i < count; i += dateBlockSize) {
+        parseIsoDateBlock(texts + i, std::min(dateBlockSize, count - i), results + i);
+    }
+#else
+    for (std::size_t i{0}; i < count; i++) {
+        results[i] = parseIsoDate(texts[i]);
+    }
+#endif
+    return static_cast<std::size_t>(std::count_if(results, results + count,
+        [](const DateParseResult& result) { return static_cast<bool>(result); }));
+}
+
+std::string_view describeDateError(DateError error) noexcept {
+    switch (error) {
+    case DateError::None:
+        return "no error";
+    case DateError::WrongLength:
+        return "expected 10 characters (YYYY-MM-DD)";
+    case DateError::BadSeparator:
+        return "expected '-' between year, month and day";
+    case DateError::NotADigit:
+        return "expected digits in year, month and day";
+    case DateError::InvalidDate:
+        return "not a valid calendar date";
+    }
+    return "unknown error";
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+// Length of a date in YYYY-MM-DD format.
+inline constexpr std::size_t isoDateLength = 10;
+
+// The numbers 00 to 99 as pairs of digits, for formatting two digits at a time.
+inline constexpr char digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Reasons why a date string could not be parsed.
+enum class DateError {
+    None,           // parsed successfully
+    WrongLength,    // not exactly 10 characters
+    BadSeparator,   // not three parts separated by '-'
+    NotADigit,      // the year, month or day does not start with a digit
+    InvalidDate     // well-formed, but not a valid calendar date (like 2023-02-30)
+};
+
+// The result of parsing one date. `date` is only meaningful
+// when `error` is `DateError::None`.
+struct DateParseResult {
+    std::chrono::year_month_day date;
+    DateError error;
+
+    explicit operator bool() const { return error == DateError::None; }
+};
+
+// Parses `text` as a date in the fixed-width YYYY-MM-DD format.
+// Never allocates or throws; failures are reported through `error`.
+// To keep old events files working, it also accepts the looser 10-character
+// forms the original parser did, like `2020-1-01x` or `+999-01-01`.
+DateParseResult parseIsoDate(std::string_view text) noexcept;
+
+// Parses `count` date strings from `texts` into `results`, with the same results
+// as `parseIsoDate`. Uses SSE2 when available to check and convert sixteen dates
+// at a time, so pass as many dates at once as possible.
+// Returns the number of dates that were parsed successfully.
+std::size_t parseIsoDates(const std::string_view* texts, std::size_t count,
+                          DateParseResult* results) noexcept;
+
+// Returns a short human-readable description of `error`.
+std::string_view describeDateError(DateError error) noexcept;
+
+// Writes `date` in YYYY-MM-DD format to `out`, which must have room for
+// `isoDateLength` characters, and returns a pointer just past the last one.
+// Only the last four digits of years outside 0 to 9999 are written; `parseIsoDate`
+// returns such years only for loose dates like `20200-1-01`.
+constexpr char* formatIsoDate(const std::chrono::year_month_day& date, char* out) noexcept {
+    const int signedYear = static_cast<int>(date.year());
+    const auto year = static_cast<unsigned>(signedYear < 0 ? -signedYear : signedYear);
+    const auto month = static_cast<unsigned>(date.month());
+    const auto day = static_cast<unsigned>(date.day());
+
+    auto putPair = [&out](unsigned value) {
+        *out++ = digitPairs[value * 2];
+        *out++ = digitPairs[value * 2 + 1];
+    };
+    putPair(year / 100 % 100);
+    putPair(year % 100);
+    *out++ = '-';
+    putPair(month);
+    *out++ = '-';
+    putPair(day);
+    return out;
+}
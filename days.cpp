@@ -1,5 +1,4 @@
 #include <iostream> // for standard I/O streams
-#include <iomanip>  // for stream control
 #include <string>   // for std::string class
 #include <cstdlib>  // for std::getenv
 #include <chrono>   // for the std::chrono facilities
@@ -8,67 +7,34 @@
 #include <optional> // for std::optional
 #include <string_view>  // for std::string_view
 #include <filesystem>  // for path utilities
+#include <fstream>  // for std::ifstream
 #include <memory>   // for smart pointers
+#include <memory_resource>  // for the per-run arena
+#include <charconv> // for std::from_chars
+#include <algorithm> // for std::min_element
+#include <span>     // for std::span
+#include <thread>   // for std::thread
 
 #include "event.h"  // for our Event class
+#include "eventstore.h"  // for storing lots of events compactly
+#include "output.h"  // for buffered output
+#include "dateindex.h"  // for date range queries
+#include "eventcache.h"  // for caching parsed events
+#include "eventedits.h"  // for adding and deleting events
+#include "watcher.h"  // for noticing changes to the events file
+#include "server.h"  // for answering queries over a local socket
+#include "dates.h"  // for parsing dates
 #include "rapidcsv.h"  // for the header-only library RapidCSV
 
 // Parses the string `buf` for a date in YYYY-MM-DD format. If `buf` can be parsed,
 // returns a wrapped `std::chrono::year_month_day` instance, otherwise `std::nullopt`.
-// NOTE: Once clang++ and g++ implement chrono::from_stream, this could be replaced by
-// something like this:
-//  chrono::year_month_day birthdate;
-//  std::istringstream bds{birthdateValue};
-//  std::basic_istream<char> stream{bds.rdbuf()};
-//  chrono::from_stream(stream, "%F", birthdate);
-// However, I don't know how errors should be handled. Maybe this function could then
-// continue to serve as a wrapper.
-std::optional<std::chrono::year_month_day> getDateFromString(const std::string& buf) {
-    using namespace std;  // use std facilities without prefix inside this function
-
-    constexpr string_view yyyymmdd = "YYYY-MM-DD";
-    if (buf.size() != yyyymmdd.size()) {
-        return nullopt;
-    }
-
-    istringstream input(buf);
-    string part;
-    vector<string> parts;
-    while (getline(input, part, '-')) {
-        parts.push_back(part);
-    }
-    if (parts.size() != 3) {  // expecting three components, year-month-day
-        return nullopt;
+// Use `parseIsoDate` directly if you need to know why parsing failed.
+std::optional<std::chrono::year_month_day> getDateFromString(std::string_view buf) {
+    const auto result = parseIsoDate(buf);
+    if (!result) {
+        return std::nullopt;
     }
-
-    int year{0};
-    unsigned int month{0};
-    unsigned int day{0};
-    try {
-        year = stoul(parts.at(0));
-        month = stoi(parts.at(1));
-        day = stoi(parts.at(2));
-
-        auto result = chrono::year_month_day{
-            chrono::year{year},
-            chrono::month(month),
-            chrono::day(day)};
-
-        if (result.ok()) {
-            return result;
-        }
-        else {
-            return nullopt;
-        }
-    }
-    catch (invalid_argument const& ex) {
-        cerr << "conversion error: " << ex.what() << endl;
-    }
-    catch (out_of_range const& ex) {
-        cerr << "conversion error: " << ex.what() << endl;
-    }
-
-    return nullopt;
+    return result.date;
 }
 
 // Returns the value of the environment variable `name` as an `std::optional`
@@ -87,14 +53,9 @@ std::optional<std::string> getEnvironmentVariable(const std::string& name) {
 // The ostream support for `std::chrono::year_month_day` is not
 // available in most (any?) compilers, so we roll our own.
 std::string getStringFromDate(const std::chrono::year_month_day& date) {
-    std::ostringstream result;
-
-    result
-        << std::setfill('0') << std::setw(4) << static_cast<int>(date.year())
-        << "-" << std::setfill('0') << std::setw(2) << static_cast<unsigned>(date.month())
-        << "-" << std::setfill('0') << std::setw(2) << static_cast<unsigned>(date.day());
-
-    return result.str();
+    std::string result(isoDateLength, '0');
+    formatIsoDate(date, result.data());
+    return result;
 }
 
 
@@ -110,24 +71,963 @@ inline void newline() {
     std::cout << std::endl;
 }
 
-// Overload the << operator for the Event class.
-// See https://learn.microsoft.com/en-us/cpp/standard-library/overloading-the-output-operator-for-your-own-classes?view=msvc-170
-std::ostream& operator <<(std::ostream& os, const Event& event) {
+// Writes `event` to `os`. Works with any type that has the getters of `Event`.
+template <typename E>
+std::ostream& writeEvent(std::ostream& os, const E& event) {
+    char date[isoDateLength];
+    os.write(date, formatIsoDate(event.getTimestamp(), date) - date);
     os
-        << getStringFromDate(event.getTimestamp()) << ": "
+        << ": "
         << event.getDescription()
-        << " (" + event.getCategory() + ")";
+        << " (" << event.getCategory() << ")";
     return os;
 }
 
+// Overload the << operator for the Event class.
+// See https://learn.microsoft.com/en-us/cpp/standard-library/overloading-the-output-operator-for-your-own-classes?view=msvc-170
+std::ostream& operator <<(std::ostream& os, const Event& event) {
+    return writeEvent(os, event);
+}
+
+// Overload the << operator for events in an `EventStore`.
+std::ostream& operator <<(std::ostream& os, const EventRef& event) {
+    return writeEvent(os, event);
+}
+
 // Gets the number of days between two points in time.
 int getNumberOfDaysBetween(std::chrono::sys_days const& earlier, std::chrono::sys_days const& later) {
     return (later - earlier).count();
 }
 
-int main() {
+// Writes the report line for an event into `out`: the event itself and how many days
+// ago or in how many days it is from `today`. If `stableDescription` is set, `description`
+// must stay valid until `out` is flushed, so that it can be written from where it is.
+void writeEventLine(OutputBuffer& out, const std::chrono::year_month_day& timestamp, std::string_view description,
+                    std::string_view category, std::chrono::sys_days today, bool stableDescription) {
+    const auto delta = getNumberOfDaysBetween(today, std::chrono::sys_days{timestamp});
+
+    char* date = out.reserve(isoDateLength);
+    out.commit(static_cast<std::size_t>(formatIsoDate(timestamp, date) - date));
+    out.append(": ");
+    if (stableDescription) {
+        out.appendStable(description);
+    }
+    else {
+        out.append(description);
+    }
+    out.append(" (");
+    out.append(category);
+    out.append(") - ");
+
+    if (delta < 0) {
+        out.appendNumber(-delta);
+        out.append(" days ago");
+    }
+    else if (delta > 0) {
+        out.append("in ");
+        out.appendNumber(delta);
+        out.append(" days");
+    }
+    else {
+        out.append("today");
+    }
+    out.append('\n');
+}
+
+// Writes the report line for `event` into `out`.
+void writeEventLine(OutputBuffer& out, const EventRef& event, std::chrono::sys_days today) {
+    // The description lives in the event store until exit.
+    writeEventLine(out, event.getTimestamp(), event.getDescription(), event.getCategory(), today, true);
+}
+
+// Below this many events per thread, starting threads costs more than it saves.
+constexpr std::size_t minEventsPerThread{32 * 1024};
+
+// Writes the report lines for the events in `events` at `selected`, in that order, into `out`.
+// A long report is formatted by several threads, each into its own buffer for its own part
+// of `selected`, and the buffers are then written out in order, so the output is the same
+// as formatting it on one thread.
+void writeEventLines(OutputBuffer& out, const EventStore& events, std::span<const std::size_t> selected,
+                     std::chrono::sys_days today) {
+    const auto threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                   selected.size() / minEventsPerThread);
+    if (threadCount <= 1) {
+        for (const auto index : selected) {
+            writeEventLine(out, events[index], today);
+        }
+        return;
+    }
+
+    std::vector<std::string> parts(threadCount);
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    auto formatPart = [&](std::size_t part) {
+        const auto first = selected.size() * part / threadCount;
+        const auto last = selected.size() * (part + 1) / threadCount;
+        parts[part].reserve((last - first) * 64);  // a guess at the length of a typical line
+        OutputBuffer partOut{parts[part]};
+        for (auto i = first; i < last; i++) {
+            writeEventLine(partOut, events[selected[i]], today);
+        }
+    };
+    for (std::size_t part{1}; part < threadCount; part++) {
+        threads.emplace_back(formatPart, part);
+    }
+    formatPart(0);  // this thread does its share too
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& part : parts) {
+        out.appendStable(part);
+    }
+    out.flush();  // before the parts go away
+}
+
+// Prints a warning for each of `badDateRows`.
+void reportBadDates(std::span<const BadDateRow> badDateRows) {
+    for (const auto& badDateRow : badDateRows) {
+        std::cerr << "bad date at row " << badDateRow.row << ": " << badDateRow.dateCell
+            << " (" << describeDateError(badDateRow.error) << ")" << '\n';
+    }
+}
+
+// Reads the events from the CSV file at `eventsPath`, adding rows with bad dates to `badDateRows`.
+// Events deleted by tombstones in the file are left out.
+// Scratch memory for the columns is taken from `arena`. The number of data rows
+// in the file, including the ones with bad dates and tombstones, is stored in `rowCount`.
+EventStore readEventsFile(const std::filesystem::path& eventsPath, std::pmr::memory_resource* arena,
+                          std::size_t& rowCount, std::vector<BadDateRow>& badDateRows) {
+    using namespace std;
+
+    //
+    // Read in the CSV file from `eventsPath` using RapidCSV
+    // See https://github.com/d99kris/rapidcsv
+    //
+    // The document is memory-mapped, so the category and description views below
+    // point straight into the file contents instead of each cell being copied into a string.
+    // Big files are parsed in parallel, one piece per hardware thread.
+    rapidcsv::Document document;
+    document.LoadMapped(eventsPath.string(),
+        rapidcsv::LabelParams{}, rapidcsv::SeparatorParams{}, rapidcsv::ConverterParams{},
+        rapidcsv::LineReaderParams{}, rapidcsv::ParallelParams{0});
+
+    // Pull all three columns out in one pass, then parse the whole date column
+    // at once, so that the dates are parsed in batches.
+    rowCount = document.GetRowCount();
+    pmr::vector<string_view> dateStrings(rowCount, arena);
+    pmr::vector<string_view> categoryStrings(rowCount, arena);
+    pmr::vector<string_view> descriptionStrings(rowCount, arena);
+    auto toView = [](string_view cell, string_view& view) { view = cell; };
+    document.GetColumns(
+        rapidcsv::MakeColumnProjection("date", dateStrings.data(), toView),
+        rapidcsv::MakeColumnProjection("category", categoryStrings.data(), toView),
+        rapidcsv::MakeColumnProjection("description", descriptionStrings.data(), toView));
+    pmr::vector<DateParseResult> dates(rowCount, arena);
+    parseIsoDates(dateStrings.data(), rowCount, dates.data());
+
+    EventStore events;
+    size_t descriptionBytes{0};
+    for (const auto& description : descriptionStrings) {
+        descriptionBytes += description.size();
+    }
+    events.reserve(dates.size(), descriptionBytes);
+
+    Tombstones tombstones;
+    for (size_t i{0}; i < dates.size(); i++) {
+        if (!dates.at(i)) {
+            const auto dateCell = dateStrings.at(i);
+            if (const auto deleted = parseTombstoneDate(dateCell)) {
+                tombstones.add(deleted.value(), categoryStrings.at(i), descriptionStrings.at(i), events.size());
+                continue;
+            }
+            badDateRows.push_back({i, string{dateCell}, dates.at(i).error});
+            continue;
+        }
+
+        events.add(dates.at(i).date, categoryStrings.at(i), descriptionStrings.at(i));
+    }
+    tombstones.deleteFrom(events);
+
+    return events;
+}
+
+// Adds the events from the rows between byte offsets `offset` and `end` of the events file at
+// `eventsPath` to `events`, and the rows with bad dates to `badDateRows`. Tombstones in these rows delete events
+// from `events`, old or new, so `events` must not have deleted events in it. The rows before `offset` are
+// `rowCount` data rows that have already been read. Returns the new total number of data rows,
+// or `std::nullopt` if the columns can't be found.
+std::optional<std::size_t> appendEvents(const std::filesystem::path& eventsPath, std::uint64_t offset,
+                                        std::uint64_t end, std::size_t rowCount, EventStore& events,
+                                        std::vector<BadDateRow>& badDateRows) {
+    using namespace std;
+
+    vector<string> row;
+    rapidcsv::RowReader headerReader{eventsPath.string()};
+    if (!headerReader.ReadRow(row)) {
+        return nullopt;
+    }
+    const auto columns = findEventColumns(row);
+    if (!columns.has_value()) {
+        return nullopt;
+    }
+
+    ifstream stream{eventsPath, ios::binary};
+    stream.seekg(static_cast<streamoff>(offset));
+    rapidcsv::RowReader reader{stream, static_cast<streamsize>(end - offset)};
+    Tombstones tombstones;
+    for (; reader.ReadRow(row); rowCount++) {
+        const auto date = parseIsoDate(getCell(row, columns->date));
+        if (!date) {
+            if (const auto deleted = parseTombstoneDate(getCell(row, columns->date))) {
+                tombstones.add(deleted.value(), getCell(row, columns->category), getCell(row, columns->description),
+                               events.size());
+                continue;
+            }
+            badDateRows.push_back({rowCount, string{getCell(row, columns->date)}, date.error});
+            continue;
+        }
+        events.add(date.date, getCell(row, columns->category), getCell(row, columns->description));
+    }
+    tombstones.deleteFrom(events);
+    return rowCount;
+}
+
+// Returns the events from the CSV file at `eventsPath`. If `useCache` is set,
+// they come from the binary cache next to it (`events.bin`) when that is up to date,
+// otherwise the CSV file is parsed and the cache is refreshed for the next time.
+// When rows have only been appended to the CSV file since the cache was made,
+// just the new rows are parsed and added to the cached events.
+// `source` is set to the version of the CSV file the events were read from, or reset
+// if that is not known because the file could not be read or changed while being read.
+// Rows with bad dates are reported every time, also when the events come from the cache.
+EventStore loadEvents(const std::filesystem::path& eventsPath, bool useCache, std::pmr::memory_resource* arena,
+                      std::optional<EventCacheStamp>& source) {
+    source.reset();
+    const auto fingerprint = getCsvFingerprint(eventsPath);
+    auto cachePath = eventsPath;
+    cachePath.replace_extension(".bin");
+
+    if (useCache && fingerprint.has_value()) {
+        if (auto cached = loadEventCache(cachePath, fingerprint.value())) {
+            source = EventCacheStamp{fingerprint.value(), cached->rowCount, cached->badDateRows.size(), cached->contents};
+            reportBadDates(cached->badDateRows);
+            return std::move(cached->events);
+        }
+
+        const auto stamp = readEventCacheStamp(cachePath);
+        if (stamp.has_value() && hasOnlyGrown(eventsPath, stamp->csv, stamp->contents)) {
+            if (auto cached = loadEventCache(cachePath, stamp->csv)) {
+                auto events = std::move(cached->events);
+                auto badDateRows = std::move(cached->badDateRows);
+                const auto rowCount = appendEvents(eventsPath, stamp->csv.size, fingerprint->size,
+                                                   static_cast<std::size_t>(stamp->rowCount), events, badDateRows);
+                const auto contents = hashCsvContents(eventsPath, fingerprint->size);
+                if (rowCount.has_value() && contents.has_value()) {
+                    source = EventCacheStamp{fingerprint.value(), rowCount.value(), badDateRows.size(), contents.value()};
+                    saveEventCache(cachePath, source.value(), events, badDateRows);
+                    reportBadDates(badDateRows);
+                    return events;
+                }
+            }
+        }
+    }
+
+    std::size_t rowCount{0};
+    std::vector<BadDateRow> badDateRows;
+    auto events = readEventsFile(eventsPath, arena, rowCount, badDateRows);
+    reportBadDates(badDateRows);
+
+    // The whole file was parsed, so it only matches the fingerprint if nothing was added meanwhile.
+    const auto contents = fingerprint.has_value() ? hashCsvContents(eventsPath, fingerprint->size) : std::nullopt;
+    if (contents.has_value() && getCsvFingerprint(eventsPath) == fingerprint) {
+        source = EventCacheStamp{fingerprint.value(), rowCount, badDateRows.size(), contents.value()};
+        if (useCache) {
+            // If this fails, we just parse again next time.
+            saveEventCache(cachePath, source.value(), events, badDateRows);
+        }
+    }
+    return events;
+}
+
+// Options given on the command line.
+struct Options {
+    std::optional<std::string> category;  // only show events in this category
+    bool groupByCategory{false};          // show events grouped by category
+    bool gatherWrites{false};             // write output with writev() instead of copying it
+    std::optional<std::chrono::sys_days> from;  // only show events on or after this date
+    std::optional<std::chrono::sys_days> to;    // only show events on or before this date
+    std::optional<int> within;            // only show events from today to this many days away
+    bool nearest{false};                  // only show the event closest to today
+    std::optional<std::size_t> next;      // only show this many events from today on, soonest first
+    std::optional<std::size_t> last;      // only show this many events before today, most recent first
+    bool onThisDay{false};                // only show events on today's month and day in any year
+    bool useCache{true};                  // load the events from events.bin when it is up to date
+    bool stream{false};                   // read and show the events one at a time, in file order
+    bool watch{false};                    // keep running and show the report again whenever it changes
+    bool serve{false};                    // keep the events in memory and answer queries on a socket
+    bool client{false};                   // ask a running server for the report before reading the file
+
+    // Returns `true` if only events in some range of dates should be shown.
+    bool hasDateRange() const {
+        return from.has_value() || to.has_value() || within.has_value();
+    }
+
+    // Returns how many events `--next` or `--last` asks for, if either was given.
+    std::optional<std::size_t> getClosestCount() const {
+        return next.has_value() ? next : last;
+    }
+};
+
+// Parses the command-line arguments into `options`.
+// Returns `false` and prints a message to `errors` if the arguments are not valid.
+bool parseOptions(int argc, char* argv[], Options& options, std::ostream& errors = std::cerr) {
+    for (int i{1}; i < argc; i++) {
+        const std::string_view arg{argv[i]};
+        if (arg == "--category" && i + 1 < argc) {
+            options.category = argv[++i];
+        }
+        else if (arg == "--by-category") {
+            options.groupByCategory = true;
+        }
+        else if (arg == "--writev") {
+            options.gatherWrites = true;
+        }
+        else if ((arg == "--from" || arg == "--to") && i + 1 < argc) {
+            const auto date = getDateFromString(argv[++i]);
+            if (!date.has_value()) {
+                errors << "expected a date in YYYY-MM-DD format after " << arg << '\n';
+                return false;
+            }
+            (arg == "--from" ? options.from : options.to) = std::chrono::sys_days{date.value()};
+        }
+        else if (arg == "--within" && i + 1 < argc) {
+            const std::string_view value{argv[++i]};
+            int days{0};
+            const auto result = std::from_chars(value.data(), value.data() + value.size(), days);
+            if (result.ec != std::errc{} || result.ptr != value.data() + value.size()) {
+                errors << "expected a number of days after --within" << '\n';
+                return false;
+            }
+            options.within = days;
+        }
+        else if ((arg == "--next" || arg == "--last") && i + 1 < argc) {
+            const std::string_view value{argv[++i]};
+            std::size_t count{0};
+            const auto result = std::from_chars(value.data(), value.data() + value.size(), count);
+            if (result.ec != std::errc{} || result.ptr != value.data() + value.size()) {
+                errors << "expected a number of events after " << arg << '\n';
+                return false;
+            }
+            (arg == "--next" ? options.next : options.last) = count;
+        }
+        else if (arg == "--nearest") {
+            options.nearest = true;
+        }
+        else if (arg == "--on-this-day") {
+            options.onThisDay = true;
+        }
+        else if (arg == "--no-cache") {
+            options.useCache = false;
+        }
+        else if (arg == "--stream") {
+            options.stream = true;
+        }
+        else if (arg == "--watch") {
+            options.watch = true;
+        }
+        else if (arg == "--serve") {
+            options.serve = true;
+        }
+        else if (arg == "--client") {
+            options.client = true;
+        }
+        else {
+            errors << "unknown or incomplete option: " << arg << '\n'
+                << "usage: days [--category NAME] [--by-category] [--from DATE] [--to DATE]"
+                << " [--within DAYS] [--nearest] [--next K | --last K] [--on-this-day] [--no-cache] [--stream] [--watch]"
+                << " [--serve | --client] [--writev]" << '\n'
+                << "       days add DATE CATEGORY DESCRIPTION | days delete DATE CATEGORY DESCRIPTION | days compact"
+                << '\n';
+            return false;
+        }
+    }
+    if (options.stream && options.groupByCategory) {
+        errors << "--by-category can't be used with --stream" << '\n';
+        return false;
+    }
+    if (options.stream && options.watch) {
+        errors << "--watch can't be used with --stream" << '\n';
+        return false;
+    }
+    if (options.next.has_value() && options.last.has_value()) {
+        errors << "--next and --last can't be used together" << '\n';
+        return false;
+    }
+    if (options.nearest && options.getClosestCount().has_value()) {
+        errors << "--nearest can't be used with --next or --last" << '\n';
+        return false;
+    }
+    if (options.serve && (options.stream || options.watch || options.client)) {
+        errors << "--serve can't be used with --stream, --watch or --client" << '\n';
+        return false;
+    }
+    return true;
+}
+
+// Returns the first and last date to show according to `options`.
+std::pair<std::chrono::sys_days, std::chrono::sys_days> getDateRange(const Options& options, std::chrono::sys_days today) {
+    auto first = std::chrono::sys_days::min();
+    auto last = std::chrono::sys_days::max();
+    if (options.from.has_value()) {
+        first = options.from.value();
+    }
+    if (options.to.has_value()) {
+        last = options.to.value();
+    }
+    if (options.within.has_value()) {
+        const auto away = today + std::chrono::days{options.within.value()};
+        first = std::max(first, std::min(today, away));
+        last = std::min(last, std::max(today, away));
+    }
+    return {first, last};
+}
+
+// Returns `true` if `a` is closer to `today` than `b`. Of two days
+// equally far away, the upcoming one is closer.
+bool isCloser(std::chrono::sys_days a, std::chrono::sys_days b, std::chrono::sys_days today) {
+    const auto da = a - today;
+    const auto db = b - today;
+    return std::chrono::abs(da) < std::chrono::abs(db)
+        || (std::chrono::abs(da) == std::chrono::abs(db) && da > db);
+}
+
+// Returns `true` if `date` is on the same month and day as `today` in any year.
+// In years without a February 29th, February 29th counts as February 28th.
+bool isAnniversary(const std::chrono::year_month_day& date, const std::chrono::year_month_day& today) {
+    using namespace std::chrono;
+    if (date.month() == today.month() && date.day() == today.day()) {
+        return true;
+    }
+    return !today.year().is_leap() && today.month() == February && today.day() == day{28}
+        && date.month() == February && date.day() == day{29};
+}
+
+// Where an event stands in the order of `--next` and `--last`: closest to today
+// first, and events on the same day in file order.
+struct Closeness {
+    int days;         // how far the event is from today
+    std::size_t row;  // where the event is in the file
+    auto operator<=>(const Closeness&) const = default;
+};
+
+// Returns how many days `day` is from today in the direction `options` looks,
+// or `std::nullopt` if `day` is on the other side of today. Today counts as upcoming.
+std::optional<int> getDistance(const Options& options, std::chrono::sys_days day, std::chrono::sys_days today) {
+    const auto distance = options.last.has_value() ? today - day : day - today;
+    if (distance.count() < 0 || (options.last.has_value() && distance.count() == 0)) {
+        return std::nullopt;
+    }
+    return static_cast<int>(distance.count());
+}
+
+// Returns the indexes of the events from `events` that fall in the date range
+// given in `options`, in date order, using a sorted index of the dates.
+std::vector<std::size_t> selectByDate(const DateIndex& index, const Options& options, std::chrono::sys_days today) {
+    if (!options.hasDateRange()) {
+        const auto all = index.all();
+        return std::vector<std::size_t>(all.begin(), all.end());
+    }
+
+    const auto [first, last] = getDateRange(options, today);
+    const auto matches = index.range(first, last);
+    return std::vector<std::size_t>(matches.begin(), matches.end());
+}
+
+// Returns the indexes of the events in `events` to show, in the order to show them.
+// Categories are compared and grouped by their interned ids, not by name.
+// `indexes` are the indexes of `events`, built only if they are needed.
+std::vector<std::size_t> selectEvents(const EventStore& events, EventIndexes& indexes, const Options& options,
+                                      std::chrono::sys_days today) {
+    const auto categoryIds = events.getCategoryIds();
+
+    std::optional<CategoryId> onlyCategory;
+    if (options.category.has_value()) {
+        onlyCategory = getCategoryTable().find(options.category.value());
+        if (!onlyCategory.has_value()) {
+            return {};  // no event has this category
+        }
+    }
+
+    std::vector<std::size_t> selected;
+    if (const auto count = options.getClosestCount(); count.has_value()) {
+        // Only the closest few are shown, so pick them out of the matching events
+        // with nth_element and sort just those, instead of sorting all the dates.
+        const auto [first, last] = getDateRange(options, today);
+        const std::chrono::year_month_day todayDate{today};
+        std::vector<Closeness> candidates;
+        for (std::size_t i{0}; i < events.size(); i++) {
+            const auto day = events.getDay(i);
+            if ((onlyCategory.has_value() && categoryIds[i] != onlyCategory.value())
+                || day < first || last < day
+                || (options.onThisDay && !isAnniversary(std::chrono::year_month_day{day}, todayDate))) {
+                continue;
+            }
+            if (const auto distance = getDistance(options, day, today); distance.has_value()) {
+                candidates.push_back({distance.value(), i});
+            }
+        }
+
+        const auto kept = std::min(count.value(), candidates.size());
+        std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(kept), candidates.end());
+        candidates.resize(kept);
+        std::sort(candidates.begin(), candidates.end());
+        selected.reserve(kept);
+        for (const auto& candidate : candidates) {
+            selected.push_back(candidate.row);
+        }
+    }
+    else if (options.onThisDay) {
+        // Anniversaries come from their own index, the other limits are then simple filters.
+        const auto matches = indexes.byAnniversary().onThisDay(std::chrono::year_month_day{today});
+        const auto [first, last] = getDateRange(options, today);
+        for (const auto i : matches) {
+            const auto day = events.getDay(i);
+            if ((!onlyCategory.has_value() || categoryIds[i] == onlyCategory.value())
+                && first <= day && day <= last) {
+                selected.push_back(i);
+            }
+        }
+    }
+    else if (options.hasDateRange() || options.nearest) {
+        const auto& index = indexes.byDate();
+        if (options.nearest && !options.hasDateRange() && !onlyCategory.has_value()) {
+            const auto nearest = index.nearest(today);
+            return nearest.has_value() ? std::vector<std::size_t>{nearest.value()} : std::vector<std::size_t>{};
+        }
+
+        selected = selectByDate(index, options, today);
+        if (onlyCategory.has_value()) {
+            std::erase_if(selected, [&](std::size_t i) { return categoryIds[i] != onlyCategory.value(); });
+        }
+        if (options.nearest && !selected.empty()) {
+            // Keep only the selected event closest to today, preferring upcoming events.
+            const auto closer = [&events, today](std::size_t a, std::size_t b) {
+                return isCloser(events.getDay(a), events.getDay(b), today);
+            };
+            selected = {*std::min_element(selected.begin(), selected.end(), closer)};
+        }
+    }
+    else {
+        selected.reserve(events.size());
+        for (std::size_t i{0}; i < events.size(); i++) {
+            if (!onlyCategory.has_value() || categoryIds[i] == onlyCategory.value()) {
+                selected.push_back(i);
+            }
+        }
+    }
+
+    if (options.groupByCategory) {
+        // Counting sort by category id keeps the file order within each category.
+        std::vector<std::size_t> starts(getCategoryTable().size() + 1, 0);
+        for (auto i : selected) {
+            starts[categoryIds[i] + 1]++;
+        }
+        for (std::size_t id{1}; id < starts.size(); id++) {
+            starts[id] += starts[id - 1];
+        }
+        std::vector<std::size_t> grouped(selected.size());
+        for (auto i : selected) {
+            grouped[starts[categoryIds[i]]++] = i;
+        }
+        selected = std::move(grouped);
+    }
+
+    return selected;
+}
+
+// Reads the events from the CSV file at `eventsPath` one row at a time and writes the ones
+// selected by `options` into `out` as soon as they are read, in file order. Events in a date
+// range are shown in date order instead, like `selectEvents` does, so they are kept until the
+// end of the file. Otherwise only the current row, the tombstones in the file, and the closest
+// events so far for `--nearest`, `--next` and `--last`, are kept in memory, however big the file is.
+// Returns `false` if the file does not have the expected columns.
+bool streamEvents(const std::filesystem::path& eventsPath, const Options& options,
+                  std::chrono::sys_days today, OutputBuffer& out) {
     using namespace std;
 
+    rapidcsv::RowReader reader{eventsPath.string()};
+    vector<string> row;
+    if (!reader.ReadRow(row)) {
+        return true;  // an empty file has no events
+    }
+    const auto columns = findEventColumns(row);
+    if (!columns.has_value()) {
+        cerr << "expected the columns date, category and description in " << eventsPath.string() << '\n';
+        return false;
+    }
+
+    // A tombstone comes after the event it deletes, so they are all read before the events.
+    auto tombstones = readTombstones(eventsPath);
+
+    const auto [first, last] = getDateRange(options, today);
+    const chrono::year_month_day todayDate{today};
+    const bool onlyNearest = options.nearest && !options.onThisDay;
+
+    // The closest event so far, when only that one is shown.
+    optional<chrono::year_month_day> nearestDate;
+    string nearestCategory;
+    string nearestDescription;
+
+    // The closest events so far for `--next` and `--last`, as a heap with the farthest on top.
+    struct Kept {
+        Closeness closeness;
+        chrono::year_month_day date;
+        string category;
+        string description;
+    };
+    const auto closestCount = options.getClosestCount();
+    vector<Kept> closest;
+    const auto isCloserKept = [](const Kept& a, const Kept& b) { return a.closeness < b.closeness; };
+
+    // The events in the date range so far, in file order, when they are shown in date order.
+    struct Matched {
+        chrono::year_month_day date;
+        string category;
+        string description;
+    };
+    const bool inDateOrder = options.hasDateRange() && !options.nearest && !options.onThisDay && !closestCount.has_value();
+    vector<Matched> matched;
+
+    for (size_t i{0}; reader.ReadRow(row); i++) {
+        const auto date = parseIsoDate(getCell(row, columns->date));
+        if (!date) {
+            if (const auto deleted = parseTombstoneDate(getCell(row, columns->date))) {
+                tombstones.pass(deleted.value(), getCell(row, columns->category), getCell(row, columns->description));
+                continue;
+            }
+            cerr << "bad date at row " << i << ": " << getCell(row, columns->date)
+                << " (" << describeDateError(date.error) << ")" << '\n';
+            continue;
+        }
+        if (!tombstones.empty()
+            && tombstones.isDeleted(date.date, getCell(row, columns->category), getCell(row, columns->description))) {
+            continue;
+        }
+
+        const chrono::sys_days day{date.date};
+        if ((options.category.has_value() && getCell(row, columns->category) != options.category.value())
+            || day < first || last < day
+            || (options.onThisDay && !isAnniversary(date.date, todayDate))) {
+            continue;
+        }
+
+        if (closestCount.has_value()) {
+            const auto distance = getDistance(options, day, today);
+            if (!distance.has_value() || closestCount.value() == 0) {
+                continue;
+            }
+            const Closeness closeness{distance.value(), i};
+            if (closest.size() == closestCount.value()) {
+                if (!(closeness < closest.front().closeness)) {
+                    continue;
+                }
+                // Drop the farthest one, and reuse its strings for this one.
+                pop_heap(closest.begin(), closest.end(), isCloserKept);
+            }
+            else {
+                closest.emplace_back();
+            }
+            auto& kept = closest.back();
+            kept.closeness = closeness;
+            kept.date = date.date;
+            kept.category = getCell(row, columns->category);
+            kept.description = getCell(row, columns->description);
+            push_heap(closest.begin(), closest.end(), isCloserKept);
+            continue;
+        }
+        if (onlyNearest) {
+            if (!nearestDate.has_value() || isCloser(day, chrono::sys_days{nearestDate.value()}, today)) {
+                nearestDate = date.date;
+                nearestCategory = getCell(row, columns->category);
+                nearestDescription = getCell(row, columns->description);
+            }
+            continue;
+        }
+        if (inDateOrder) {
+            matched.push_back({date.date, string{getCell(row, columns->category)}, string{getCell(row, columns->description)}});
+            continue;
+        }
+        writeEventLine(out, date.date, getCell(row, columns->description), getCell(row, columns->category), today, false);
+    }
+
+    // Events on the same date stay in file order.
+    stable_sort(matched.begin(), matched.end(), [](const Matched& a, const Matched& b) {
+        return chrono::sys_days{a.date} < chrono::sys_days{b.date};
+    });
+    for (const auto& event : matched) {
+        writeEventLine(out, event.date, event.description, event.category, today, false);
+    }
+
+    if (nearestDate.has_value()) {
+        writeEventLine(out, nearestDate.value(), nearestDescription, nearestCategory, today, false);
+    }
+    sort_heap(closest.begin(), closest.end(), isCloserKept);
+    for (const auto& kept : closest) {
+        writeEventLine(out, kept.date, kept.description, kept.category, today, false);
+    }
+    return true;
+}
+
+// Returns the current date as a number of days.
+std::chrono::sys_days getToday() {
+    return std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now());
+}
+
+// The events of a long-running days, kept in memory together with their indexes.
+// Rows appended to the file are parsed on their own and added to the events in memory;
+// any other change loads the whole file again. There are no events until the first `reload`.
+class LiveEvents {
+public:
+    LiveEvents(const std::filesystem::path& eventsPath, bool useCache) : eventsPath(eventsPath), useCache(useCache) { }
+
+    LiveEvents(const LiveEvents&) = delete;
+    LiveEvents& operator=(const LiveEvents&) = delete;
+
+    // Brings the events up to date with the file. Returns `false` if the file had not changed.
+    // A file whose size and modification time are as before counts as unchanged without reading it.
+    // Throws `std::exception` if the file can't be read, like while it is being replaced;
+    // the events are then kept as they were, and the next reload reads the whole file.
+    bool reload() {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(eventsPath, error);
+        const auto modified = std::filesystem::last_write_time(eventsPath, error);
+        if (!error && source.has_value() && size == source->csv.size
+            && modified.time_since_epoch().count() == source->csv.modified) {
+            return false;
+        }
+
+        const auto fingerprint = getCsvFingerprint(eventsPath);
+        if (source.has_value() && fingerprint.has_value()) {
+            if (fingerprint.value() == source->csv) {
+                return false;
+            }
+            if (hasOnlyGrown(eventsPath, source->csv, source->contents)) {
+                // Until all the new rows are in, the events are not from any one version of the file.
+                const auto earlier = source.value();
+                source.reset();
+                std::vector<BadDateRow> badDateRows;  // only the new ones, the old ones were reported already
+                const auto rowCount = appendEvents(eventsPath, earlier.csv.size, fingerprint->size,
+                                                   static_cast<std::size_t>(earlier.rowCount), events, badDateRows);
+                reportBadDates(badDateRows);
+                const auto contents = hashCsvContents(eventsPath, fingerprint->size);
+                if (rowCount.has_value() && contents.has_value()) {
+                    source = EventCacheStamp{fingerprint.value(), rowCount.value(),
+                                             earlier.badDateRowCount + badDateRows.size(), contents.value()};
+                    indexes.reset();
+                    return true;
+                }
+            }
+        }
+
+        std::pmr::monotonic_buffer_resource arena;  // only for this load, so reloading doesn't pile up memory
+        events = loadEvents(eventsPath, useCache, &arena, source);
+        indexes.reset();
+        return true;
+    }
+
+    // Writes the report for `options` into `out`.
+    void writeReport(OutputBuffer& out, const Options& options, std::chrono::sys_days today) {
+        writeEventLines(out, events, selectEvents(events, indexes, options, today), today);
+    }
+
+private:
+    std::filesystem::path eventsPath;
+    bool useCache;
+    EventStore events;
+    EventIndexes indexes{events};
+    std::optional<EventCacheStamp> source;  // the version of the file the events are from, if known
+};
+
+// Keeps the events from `eventsPath` in memory and writes the report for `options`
+// again whenever it changes, followed by an empty line. The report is made again when
+// the events file changes and when the date changes at midnight. While the file can't be
+// read, the last events read from it are kept. Never returns.
+[[noreturn]] void watchEvents(const std::filesystem::path& eventsPath, const Options& options) {
+    FileWatcher watcher{eventsPath};
+    LiveEvents events{eventsPath, options.useCache};
+    auto reload = [&events, &eventsPath] {
+        try {
+            return events.reload();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "unable to read " << eventsPath.string() << ": " << e.what() << '\n';
+            return false;
+        }
+    };
+    reload();
+    auto today = getToday();
+    std::string previous;
+    while (true) {
+        std::string report;
+        {
+            OutputBuffer out{report};
+            events.writeReport(out, options, today);
+        }
+        if (report != previous) {
+            OutputBuffer out;
+            out.append(report);
+            out.append('\n');
+            previous = std::move(report);
+        }
+
+        // Sleep until the file changes or the next day starts.
+        bool changed{false};
+        while (!changed) {
+            const auto fileChanged = watcher.wait(std::chrono::system_clock::time_point{today + std::chrono::days{1}});
+            changed = fileChanged && reload();
+            if (getToday() != today) {
+                today = getToday();
+                changed = true;
+            }
+        }
+    }
+}
+
+// Answers one query sent to `--serve`: the report days would show if it was run with
+// the options in `args`. The events are first brought up to date with the file;
+// if it can't be read, the reply is an error.
+QueryReply answerQuery(LiveEvents& events, const std::vector<std::string>& args) {
+    std::vector<char*> argv{nullptr};  // like a command line, the first argument is not an option
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+
+    Options options;
+    std::ostringstream errors;
+    if (!parseOptions(static_cast<int>(argv.size()), argv.data(), options, errors)) {
+        return {false, errors.str()};
+    }
+    if (options.stream || options.watch || options.serve || options.client) {
+        return {false, "--stream, --watch, --serve and --client can't be used in a query\n"};
+    }
+
+    try {
+        events.reload();
+    }
+    catch (const std::exception& e) {
+        return {false, "unable to read the events: " + std::string{e.what()} + '\n'};
+    }
+    QueryReply reply{true, {}};
+    {
+        OutputBuffer out{reply.text};
+        events.writeReport(out, options, getToday());
+    }
+    return reply;
+}
+
+// Keeps the events from `eventsPath` in memory and answers queries from `days --client`
+// on `socketPath` until interrupted. Returns `false` if the socket can't be set up.
+bool serveEvents(const std::filesystem::path& eventsPath, const std::filesystem::path& socketPath,
+                 const Options& options) {
+    LiveEvents events{eventsPath, options.useCache};
+    try {
+        events.reload();
+    }
+    catch (const std::exception& e) {
+        // Maybe the file is there by the first query; if not, the query gets the error.
+        std::cerr << "unable to read " << eventsPath.string() << ": " << e.what() << '\n';
+    }
+    return serveQueries(socketPath, [&events](const std::vector<std::string>& args) {
+        return answerQuery(events, args);
+    });
+}
+
+// Returns `true` if `command` is one that changes the events file instead of showing a report.
+bool isEditCommand(std::string_view command) {
+    return command == "add" || command == "delete" || command == "compact";
+}
+
+// Carries out `days add DATE CATEGORY DESCRIPTION`, `days delete DATE CATEGORY DESCRIPTION` or
+// `days compact` on the events file at `eventsPath`. The words of the description may also be
+// given as separate arguments. An event can only be deleted if it is shown; the delete that makes
+// the dead rows of the file pass the compaction threshold also compacts it.
+// Returns `false` and prints a message if the edit could not be made.
+bool editEvents(const std::filesystem::path& eventsPath, int argc, char* argv[]) {
+    using namespace std;
+
+    const string_view command{argv[1]};
+    if (command == "compact") {
+        if (argc != 2) {
+            cerr << "usage: days compact" << '\n';
+            return false;
+        }
+        return compactEvents(eventsPath);
+    }
+
+    if (argc < 5) {
+        cerr << "usage: days " << command << " DATE CATEGORY DESCRIPTION" << '\n';
+        return false;
+    }
+    const auto date = getDateFromString(argv[2]);
+    if (!date.has_value()) {
+        cerr << "expected a date in YYYY-MM-DD format, not " << argv[2] << '\n';
+        return false;
+    }
+    const string category{argv[3]};
+    string description{argv[4]};
+    for (int i{5}; i < argc; i++) {
+        description += ' ';
+        description += argv[i];
+    }
+    // Each event is one line in the file.
+    if (category.find_first_of("\r\n") != string::npos || description.find_first_of("\r\n") != string::npos) {
+        cerr << "the category and the description can't have line breaks" << '\n';
+        return false;
+    }
+
+    if (command == "add") {
+        return appendEvent(eventsPath, date.value(), category, description);
+    }
+
+    if (!filesystem::exists(eventsPath)) {
+        cerr << "no such event: " << argv[2] << ' ' << category << ' ' << description << '\n';
+        return false;
+    }
+    pmr::monotonic_buffer_resource arena;
+    optional<EventCacheStamp> source;
+    const auto events = loadEvents(eventsPath, true, &arena, source);
+    const auto day = chrono::sys_days{date.value()}.time_since_epoch().count();
+    const auto dayNumbers = events.getDayNumbers();
+    bool found{false};
+    for (size_t i{0}; i < events.size() && !found; i++) {
+        found = dayNumbers[i] == day && events.getCategory(i) == category && events.getDescription(i) == description;
+    }
+    if (!found) {
+        cerr << "no such event: " << argv[2] << ' ' << category << ' ' << description << '\n';
+        return false;
+    }
+
+    if (!appendTombstone(eventsPath, date.value(), category, description)) {
+        return false;
+    }
+    // The tombstone is one more row, and the event is no longer shown.
+    if (source.has_value() && shouldCompact(static_cast<size_t>(source->rowCount) + 1, events.size() - 1,
+                                            static_cast<size_t>(source->badDateRowCount))) {
+        return compactEvents(eventsPath);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    using namespace std;
+
+    Options options;
+    const bool editing = argc > 1 && isEditCommand(argv[1]);
+    if (!editing && !parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
     // Get the current date from the system clock and extract year_month_day.
     // See https://en.cppreference.com/w/cpp/chrono/year_month_day
     const chrono::time_point now = chrono::system_clock::now();
@@ -205,53 +1105,60 @@ int main() {
     // Construct a pathname for the `events.csv` file.
     auto eventsPath = daysPath / "events.csv";
 
-    //
-    // Read in the CSV file from `eventsPath` using RapidCSV
-    // See https://github.com/d99kris/rapidcsv
-    //
-    rapidcsv::Document document{eventsPath.string()};
-    vector<string> dateStrings{document.GetColumn<string>("date")};
-    vector<string> categoryStrings{document.GetColumn<string>("category")};
-    vector<string> descriptionStrings{document.GetColumn<string>("description")};
-
-    vector<Event> events;
-    for (size_t i{0}; i < dateStrings.size(); i++) {
-        auto date = getDateFromString(dateStrings.at(i));
-        if (!date.has_value()) {
-            cerr << "bad date at row " << i << ": " << dateStrings.at(i) << '\n';
-            continue;
-        }
-
-        Event event{
-            date.value(),
-            categoryStrings.at(i),
-            descriptionStrings.at(i)
-        };
-        events.push_back(event);
+    if (editing) {
+        return editEvents(eventsPath, argc, argv) ? 0 : 1;
     }
 
-    const auto today = chrono::sys_days{
-        floor<chrono::days>(chrono::system_clock::now())};
+    // A running `days --serve` answers from memory, so there is no need to read the file here.
+    const auto socketPath = daysPath / "days.sock";
+    if (options.serve) {
+        return serveEvents(eventsPath, socketPath, options) ? 0 : 1;
+    }
+    if (options.client) {
+        vector<string> args;
+        for (int i{1}; i < argc; i++) {
+            if (string_view{argv[i]} != "--client") {
+                args.emplace_back(argv[i]);
+            }
+        }
+        const auto reply = sendQuery(socketPath, args);
+        if (reply.has_value()) {
+            if (!reply->ok) {
+                cerr << reply->text;
+                return 1;
+            }
+            OutputBuffer out;
+            out.append(reply->text);
+            return 0;
+        }
+        // No server is running, so make the report here instead.
+    }
 
-    for (auto& event : events) {
-        const auto delta = (chrono::sys_days{event.getTimestamp()} - today).count();
+    if (options.watch) {
+        watchEvents(eventsPath, options);
+    }
 
-        ostringstream line;
-        line << event << " - ";
+    const auto today = getToday();
 
-        if (delta < 0) {
-            line << abs(delta) << " days ago";
-        }
-        else if (delta > 0) {
-            line << "in " << delta << " days";
-        }
-        else {
-            line << "today";
-        }
+    // Memory needed until exit is taken from big blocks of one arena
+    // and given back all at once when the program ends.
+    pmr::monotonic_buffer_resource arena{1024 * 1024};
 
-        display(line.str());
-        newline();
+    // Collect the report in a large buffer and write it out in big chunks,
+    // instead of flushing standard output after every line.
+    OutputBuffer out{options.gatherWrites ? OutputBuffer::Mode::Gather : OutputBuffer::Mode::Copy,
+                     256 * 1024, &arena};
+    if (options.stream) {
+        const bool ok = streamEvents(eventsPath, options, today, out);
+        out.flush();
+        return ok ? 0 : 1;
     }
 
+    optional<EventCacheStamp> source;
+    const auto events = loadEvents(eventsPath, options.useCache, &arena, source);
+    EventIndexes indexes{events};
+    writeEventLines(out, events, selectEvents(events, indexes, options, today), today);
+    out.flush();
+
     return 0;
 }
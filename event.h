@@ -1,23 +1,31 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <utility>
+
+#include "categories.h"
 
 // Represents an event.
 class Event {
 public:
+    // The description is taken by value so that callers can move a string
+    // into the event (for example with `emplace_back`) instead of copying it.
     Event(
-        const std::chrono::year_month_day& t, 
-        const std::string& c, 
-        const std::string& d) :
-            timestamp(t), category(c), description(d) {
+        std::chrono::year_month_day t, 
+        std::string_view c, 
+        std::string d) :
+            timestamp(t), category(getCategoryTable().intern(c)), description(std::move(d)) {
 
     }
 
-    // Getters for the properties:
+    // Getters for the properties. The returned views are valid
+    // for as long as the event is alive and not modified.
     std::chrono::year_month_day getTimestamp() const;
-    std::string getCategory() const;
-    std::string getDescription() const;
+    std::string_view getCategory() const;
+    CategoryId getCategoryId() const;
+    std::string_view getDescription() const;
 
     // Overloaded operator for output stream use.
     // Needs to be `friend`, not a method in this class.
@@ -25,6 +33,6 @@ public:
 
 private:
     std::chrono::year_month_day timestamp;
-    std::string category;
+    CategoryId category;  // interned in the shared `CategoryTable`
     std::string description;
 };
@@ -0,0 +1,380 @@
+#include "eventcache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "rapidcsv.h"  // for rapidcsv::MappedFile and rapidcsv::RowWriter
+
+namespace {
+
+constexpr char cacheMagic[8] = {'D', 'A', 'Y', 'S', 'B', 'I', 'N', '\0'};
+constexpr std::uint32_t cacheVersion = 4;
+constexpr std::uint32_t byteOrderMark = 0x01020304;  // reads differently on a machine of other endianness
+
+// The cache file starts with this header. It is followed by the sections
+// days, category ids, description offsets, category name offsets, category
+// names, descriptions, bad date rows and their date cells, each starting
+// at a multiple of 8 bytes.
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    CsvFingerprint csv;
+    std::uint64_t rowCount;
+    std::uint64_t contents;
+    std::uint64_t eventCount;
+    std::uint64_t categoryCount;
+    std::uint64_t categoryBytes;
+    std::uint64_t descriptionBytes;
+    std::uint64_t badDateRowCount;
+    std::uint64_t badDateBytes;
+};
+
+// How a row with a bad date is stored. The date cells come after all these, one after the other.
+struct BadDateRecord {
+    std::uint64_t row;
+    std::uint32_t error;
+    std::uint32_t cellSize;
+};
+
+constexpr std::uint64_t align8(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t{7};
+}
+
+// Where each section of a cache file starts, and where the file ends.
+struct CacheLayout {
+    std::uint64_t days;
+    std::uint64_t categoryIds;
+    std::uint64_t descriptionOffsets;
+    std::uint64_t categoryOffsets;
+    std::uint64_t categoryNames;
+    std::uint64_t descriptions;
+    std::uint64_t badDateRows;
+    std::uint64_t badDateCells;
+    std::uint64_t end;
+};
+
+// Returns the layout for the counts in `header`, or `std::nullopt` if they are absurd.
+std::optional<CacheLayout> getLayout(const CacheHeader& header) {
+    constexpr auto limit = std::uint64_t{1} << 40;  // keeps the arithmetic below from overflowing
+    if (header.eventCount >= limit || header.categoryCount >= limit
+        || header.categoryBytes >= limit || header.descriptionBytes >= limit
+        || header.badDateRowCount >= limit || header.badDateBytes >= limit) {
+        return std::nullopt;
+    }
+
+    CacheLayout layout{};
+    layout.days = align8(sizeof(CacheHeader));
+    layout.categoryIds = align8(layout.days + header.eventCount * sizeof(EventStore::DayNumber));
+    layout.descriptionOffsets = align8(layout.categoryIds + header.eventCount * sizeof(CategoryId));
+    layout.categoryOffsets = align8(layout.descriptionOffsets + (header.eventCount + 1) * sizeof(std::uint32_t));
+    layout.categoryNames = align8(layout.categoryOffsets + (header.categoryCount + 1) * sizeof(std::uint32_t));
+    layout.descriptions = align8(layout.categoryNames + header.categoryBytes);
+    layout.badDateRows = align8(layout.descriptions + header.descriptionBytes);
+    layout.badDateCells = layout.badDateRows + header.badDateRowCount * sizeof(BadDateRecord);
+    layout.end = layout.badDateCells + header.badDateBytes;
+    return layout;
+}
+
+// FNV-1a, 64-bit.
+std::uint64_t hashBytes(std::uint64_t hash, const char* data, std::size_t size) {
+    for (std::size_t i{0}; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// Hashes all of `data` eight bytes at a time, which is fast enough to read a whole file with.
+std::uint64_t hashContents(const char* data, std::size_t size) {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    std::size_t i{0};
+    for (; i + sizeof hash <= size; i += sizeof hash) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof word);
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15;
+        hash ^= hash >> 32;
+    }
+    return hashBytes(hash, data + i, size - i);
+}
+
+// Hashes the first `size` bytes of `stream`: the first and last 64 KiB, where edits and
+// appends usually happen, and 4 KiB samples spread evenly over the rest.
+std::uint64_t hashPrefix(std::istream& stream, std::uint64_t size) {
+    constexpr std::uint64_t edgeBytes = 64 * 1024;
+    constexpr std::uint64_t sampleBytes = 4 * 1024;
+    constexpr std::uint64_t sampleCount = 16;
+
+    std::vector<char> buffer(edgeBytes);
+    std::uint64_t hash = 0xcbf29ce484222325;
+    auto hashRange = [&](std::uint64_t offset, std::uint64_t count) {
+        stream.seekg(static_cast<std::streamoff>(offset));
+        stream.read(buffer.data(), static_cast<std::streamsize>(count));
+        hash = hashBytes(hash, buffer.data(), static_cast<std::size_t>(stream.gcount()));
+        stream.clear();
+    };
+
+    if (size <= 2 * edgeBytes + sampleCount * sampleBytes) {
+        for (std::uint64_t offset{0}; offset < size; offset += edgeBytes) {
+            hashRange(offset, std::min(edgeBytes, size - offset));
+        }
+    }
+    else {
+        hashRange(0, edgeBytes);
+        const auto step = (size - 2 * edgeBytes) / sampleCount;
+        for (std::uint64_t i{0}; i < sampleCount; i++) {
+            hashRange(edgeBytes + i * step, sampleBytes);
+        }
+        hashRange(size - edgeBytes, edgeBytes);
+    }
+    return hash;
+}
+
+// Reads the header of a cache file and checks that this program can use the file.
+std::optional<CacheHeader> readHeader(const char* data, std::size_t fileSize) {
+    CacheHeader header;
+    if (fileSize < sizeof header) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data, sizeof header);
+    if (std::memcmp(header.magic, cacheMagic, sizeof cacheMagic) != 0
+        || header.version != cacheVersion || header.byteOrder != byteOrderMark) {
+        return std::nullopt;
+    }
+    const auto layout = getLayout(header);
+    if (!layout.has_value() || layout->end != fileSize) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+// Keeps a mapped cache file alive, along with category ids that had to be renumbered.
+struct CacheBacking {
+    explicit CacheBacking(const std::string& path) : file(path) { }
+
+    rapidcsv::MappedFile file;
+    std::vector<CategoryId> categoryIds;
+};
+
+}  // namespace
+
+std::optional<CsvFingerprint> getCsvFingerprint(const std::filesystem::path& csvPath) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(csvPath, error);
+    if (error) {
+        return std::nullopt;
+    }
+    const auto modified = std::filesystem::last_write_time(csvPath, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    std::ifstream stream{csvPath, std::ios::binary};
+    if (!stream) {
+        return std::nullopt;
+    }
+    return CsvFingerprint{size, static_cast<std::int64_t>(modified.time_since_epoch().count()), hashPrefix(stream, size)};
+}
+
+std::optional<std::uint64_t> hashCsvContents(const std::filesystem::path& csvPath, std::uint64_t size) {
+    try {
+        const rapidcsv::MappedFile file{csvPath.string()};
+        if (file.Size() < size) {
+            return std::nullopt;
+        }
+        return hashContents(file.Data(), static_cast<std::size_t>(size));
+    }
+    catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+bool hasOnlyGrown(const std::filesystem::path& csvPath, const CsvFingerprint& earlier, std::uint64_t earlierContents) {
+    try {
+        // Every byte of the earlier contents is hashed: a sampled hash would miss
+        // an edit between the samples that came together with an append.
+        const rapidcsv::MappedFile file{csvPath.string()};
+        if (earlier.size == 0 || file.Size() <= earlier.size || file.Data()[earlier.size - 1] != '\n') {
+            return false;
+        }
+        return hashContents(file.Data(), static_cast<std::size_t>(earlier.size)) == earlierContents;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::optional<EventCacheStamp> readEventCacheStamp(const std::filesystem::path& cachePath) {
+    try {
+        const rapidcsv::MappedFile file{cachePath.string()};
+        const auto header = readHeader(file.Data(), file.Size());
+        if (!header.has_value()) {
+            return std::nullopt;
+        }
+        return EventCacheStamp{header->csv, header->rowCount, header->badDateRowCount, header->contents};
+    }
+    catch (const std::exception&) {
+        return std::nullopt;  // no cache yet
+    }
+}
+
+std::optional<CachedEvents> loadEventCache(const std::filesystem::path& cachePath, const CsvFingerprint& csv) {
+    std::shared_ptr<CacheBacking> backing;
+    try {
+        backing = std::make_shared<CacheBacking>(cachePath.string());
+    }
+    catch (const std::exception&) {
+        return std::nullopt;  // no cache yet
+    }
+
+    const char* data = backing->file.Data();
+    const auto checked = readHeader(data, backing->file.Size());
+    if (!checked.has_value() || !(checked->csv == csv)) {
+        return std::nullopt;
+    }
+    const auto& header = checked.value();
+    const auto layout = getLayout(header);
+
+    const auto count = static_cast<std::size_t>(header.eventCount);
+    EventStore::Columns columns{
+        {reinterpret_cast<const EventStore::DayNumber*>(data + layout->days), count},
+        {reinterpret_cast<const CategoryId*>(data + layout->categoryIds), count},
+        {reinterpret_cast<const std::uint32_t*>(data + layout->descriptionOffsets), count + 1},
+        {data + layout->descriptions, static_cast<std::size_t>(header.descriptionBytes)}
+    };
+    // The events are used straight from the file, so a corrupt cache must not get past here:
+    // every description has to lie within the descriptions, and every category id has to have a name.
+    const auto descriptionOffsets = columns.descriptionOffsets;
+    if (descriptionOffsets.front() != 0 || descriptionOffsets.back() != header.descriptionBytes
+        || !std::is_sorted(descriptionOffsets.begin(), descriptionOffsets.end())) {
+        return std::nullopt;
+    }
+    if (std::any_of(columns.categoryIds.begin(), columns.categoryIds.end(),
+                    [&header](CategoryId id) { return id >= header.categoryCount; })) {
+        return std::nullopt;
+    }
+    const auto* nameOffsets = reinterpret_cast<const std::uint32_t*>(data + layout->categoryOffsets);
+    const std::string_view names{data + layout->categoryNames, static_cast<std::size_t>(header.categoryBytes)};
+    for (std::size_t i{0}; i < header.categoryCount; i++) {
+        if (nameOffsets[i] > nameOffsets[i + 1] || nameOffsets[i + 1] > names.size()) {
+            return std::nullopt;
+        }
+    }
+
+    // Intern the category names in their cached order. In a fresh process
+    // the ids come out the same as in the cache, otherwise renumber them.
+    std::vector<CategoryId> ids;
+    bool renumber = false;
+    for (std::size_t i{0}; i < header.categoryCount; i++) {
+        ids.push_back(getCategoryTable().intern(names.substr(nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i])));
+        renumber = renumber || ids.back() != i;
+    }
+    if (renumber) {
+        backing->categoryIds.reserve(count);
+        for (const auto id : columns.categoryIds) {
+            backing->categoryIds.push_back(ids[id]);
+        }
+        columns.categoryIds = backing->categoryIds;
+    }
+
+    // The few rows with bad dates are copied out, as they are only printed.
+    std::vector<BadDateRow> badDateRows;
+    std::string_view cells{data + layout->badDateCells, static_cast<std::size_t>(header.badDateBytes)};
+    for (std::size_t i{0}; i < header.badDateRowCount; i++) {
+        BadDateRecord record;
+        std::memcpy(&record, data + layout->badDateRows + i * sizeof record, sizeof record);
+        if (record.cellSize > cells.size() || record.error > static_cast<std::uint32_t>(DateError::InvalidDate)) {
+            return std::nullopt;
+        }
+        badDateRows.push_back({record.row, std::string{cells.substr(0, record.cellSize)},
+                               static_cast<DateError>(record.error)});
+        cells.remove_prefix(record.cellSize);
+    }
+
+    return CachedEvents{EventStore::borrow(columns, std::move(backing)), header.rowCount, header.contents,
+                        std::move(badDateRows)};
+}
+
+bool saveEventCache(const std::filesystem::path& cachePath, const EventCacheStamp& stamp, const EventStore& events,
+                    std::span<const BadDateRow> badDateRows) {
+    const auto& columns = events.getColumns();
+    const auto& categories = getCategoryTable();
+
+    std::vector<std::uint32_t> nameOffsets{0};
+    std::string names;
+    for (CategoryId id{0}; id < categories.size(); id++) {
+        names += categories.getName(id);
+        nameOffsets.push_back(static_cast<std::uint32_t>(names.size()));
+    }
+
+    std::vector<BadDateRecord> badDateRecords;
+    std::string badDateCells;
+    for (const auto& badDateRow : badDateRows) {
+        badDateRecords.push_back({badDateRow.row, static_cast<std::uint32_t>(badDateRow.error),
+                                  static_cast<std::uint32_t>(badDateRow.dateCell.size())});
+        badDateCells += badDateRow.dateCell;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, cacheMagic, sizeof cacheMagic);
+    header.version = cacheVersion;
+    header.byteOrder = byteOrderMark;
+    header.csv = stamp.csv;
+    header.rowCount = stamp.rowCount;
+    header.contents = stamp.contents;
+    header.eventCount = columns.days.size();
+    header.categoryCount = categories.size();
+    header.categoryBytes = names.size();
+    header.descriptionBytes = columns.descriptionArena.size();
+    header.badDateRowCount = badDateRecords.size();
+    header.badDateBytes = badDateCells.size();
+    const auto layout = getLayout(header);
+    if (!layout.has_value()) {
+        return false;
+    }
+
+    // Several runs may save the cache at once, so each writes a temporary file of its own.
+    std::string temporaryPath;
+    try {
+        temporaryPath = rapidcsv::RowWriter::CreateTempFile(cachePath.string());
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    std::error_code error;
+    {
+        std::ofstream stream{temporaryPath, std::ios::binary | std::ios::trunc};
+        auto put = [&stream](std::uint64_t offset, const void* data, std::size_t size) {
+            static constexpr char padding[8] = {};
+            stream.write(padding, static_cast<std::streamsize>(offset - static_cast<std::uint64_t>(stream.tellp())));
+            stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+        put(0, &header, sizeof header);
+        put(layout->days, columns.days.data(), columns.days.size_bytes());
+        put(layout->categoryIds, columns.categoryIds.data(), columns.categoryIds.size_bytes());
+        put(layout->descriptionOffsets, columns.descriptionOffsets.data(), columns.descriptionOffsets.size_bytes());
+        put(layout->categoryOffsets, nameOffsets.data(), nameOffsets.size() * sizeof(std::uint32_t));
+        put(layout->categoryNames, names.data(), names.size());
+        put(layout->descriptions, columns.descriptionArena.data(), columns.descriptionArena.size());
+        put(layout->badDateRows, badDateRecords.data(), badDateRecords.size() * sizeof(BadDateRecord));
+        put(layout->badDateCells, badDateCells.data(), badDateCells.size());
+        if (!stream.flush()) {
+            stream.close();
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    try {
+        rapidcsv::RowWriter::ReplaceFile(temporaryPath, cachePath.string());  // removes the file on failure
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
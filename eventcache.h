@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "dates.h"
+#include "eventstore.h"
+
+// Identifies one version of an events CSV file, so that a cache made
+// from it can be recognized as stale once the file changes.
+struct CsvFingerprint {
+    std::uint64_t size;
+    std::int64_t modified;  // last write time, in the file clock's ticks
+    std::uint64_t hash;     // hash of the start, the end and samples in between
+
+    bool operator==(const CsvFingerprint&) const = default;
+};
+
+// Returns the fingerprint of the file at `csvPath`, or `std::nullopt` if it can't be read.
+// Only a fixed amount of the file is hashed, so this takes about the same time for any size.
+std::optional<CsvFingerprint> getCsvFingerprint(const std::filesystem::path& csvPath);
+
+// Returns a hash of all of the first `size` bytes of the file at `csvPath`, or `std::nullopt`
+// if it can't be read or is shorter. Unlike the fingerprint, this reads every byte.
+std::optional<std::uint64_t> hashCsvContents(const std::filesystem::path& csvPath, std::uint64_t size);
+
+// Returns `true` if the CSV file at `csvPath` is the file that had the fingerprint `earlier`
+// and the contents hash `earlierContents` with only whole lines appended to it since: it is
+// bigger, its first `earlier.size` bytes still have the same contents hash, and they end with
+// a linebreak, so that the last record then was complete. A truncated file, or one edited
+// anywhere before the end of the earlier contents, gives `false`.
+bool hasOnlyGrown(const std::filesystem::path& csvPath, const CsvFingerprint& earlier, std::uint64_t earlierContents);
+
+// A data row of a CSV file whose date could not be parsed. The cache keeps these,
+// so that they are reported on every run, not just the one that parsed the file.
+struct BadDateRow {
+    std::uint64_t row;  // counting the data rows from 0
+    std::string dateCell;
+    DateError error;
+};
+
+// What a cache file records about the CSV file it was made from.
+struct EventCacheStamp {
+    CsvFingerprint csv;
+    std::uint64_t rowCount;  // data rows parsed from the CSV file, including rows with bad dates
+    std::uint64_t badDateRowCount;  // of those, the rows with bad dates
+    std::uint64_t contents;  // `hashCsvContents` of the whole CSV file
+};
+
+// Reads the stamp of the cache file `cachePath`, without loading the events.
+// Returns `std::nullopt` if there is no valid cache file.
+std::optional<EventCacheStamp> readEventCacheStamp(const std::filesystem::path& cachePath);
+
+// The events loaded from a cache file.
+struct CachedEvents {
+    EventStore events;
+    std::uint64_t rowCount;  // data rows they were parsed from, including rows with bad dates
+    std::uint64_t contents;  // `hashCsvContents` of the CSV file they were parsed from
+    std::vector<BadDateRow> badDateRows;
+};
+
+// Loads the events cached in `cachePath` by memory-mapping it, if the cache
+// was made from a CSV file with the fingerprint `csv`. Otherwise returns `std::nullopt`,
+// as it also does for a cache that is not consistent, like one that was damaged.
+std::optional<CachedEvents> loadEventCache(const std::filesystem::path& cachePath, const CsvFingerprint& csv);
+
+// Saves `events`, parsed from `rowCount` data rows of a CSV file with the fingerprint and contents
+// hash in `stamp`, to `cachePath`, along with the rows of the file that had bad dates. The file is
+// written under a temporary name of its own, synced and then renamed, so readers never see a
+// half-written cache, even with several runs saving it at once. Returns `false` if the cache
+// could not be written.
+bool saveEventCache(const std::filesystem::path& cachePath, const EventCacheStamp& stamp, const EventStore& events,
+                    std::span<const BadDateRow> badDateRows);
@@ -0,0 +1,312 @@
+#include "eventedits.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <system_error>
+
+#include "dates.h"
+#include "eventcache.h"  // for getCsvFingerprint
+#include "rapidcsv.h"
+
+namespace {
+
+// Marks the date cell of a tombstone.
+constexpr std::string_view tombstoneMarker{"deleted:"};
+
+// Compaction waits for at least this many dead rows, and for them to be at least
+// this share of all rows, so that a rewrite is paid for by many deletes.
+constexpr std::size_t minDeadRowsToCompact{64};
+constexpr std::size_t deadRowShareToCompact{4};  // one in four
+
+EventStore::DayNumber getDayNumber(const std::chrono::year_month_day& date) {
+    return std::chrono::sys_days{date}.time_since_epoch().count();
+}
+
+// Stores the date, category and description of an event in `key`, so that two events
+// get the same key exactly when all three are the same.
+void makeEventKey(std::string& key, EventStore::DayNumber day, std::string_view category, std::string_view description) {
+    const auto categoryLength = static_cast<std::uint32_t>(category.size());
+    key.assign(reinterpret_cast<const char*>(&day), sizeof day);
+    key.append(reinterpret_cast<const char*>(&categoryLength), sizeof categoryLength);
+    key.append(category);
+    key.append(description);
+}
+
+// Returns the date cell of a tombstone for an event on `date`.
+std::string getTombstoneDate(const std::chrono::year_month_day& date) {
+    std::string cell{tombstoneMarker};
+    cell.resize(tombstoneMarker.size() + isoDateLength);
+    formatIsoDate(date, cell.data() + tombstoneMarker.size());
+    return cell;
+}
+
+// Returns `true` if the tombstone marker appears anywhere in the file at `eventsPath`.
+bool containsTombstoneMarker(const std::filesystem::path& eventsPath) {
+    try {
+        const rapidcsv::MappedFile file{eventsPath.string()};
+        return std::string_view{file.Data(), file.Size()}.find(tombstoneMarker) != std::string_view::npos;
+    }
+    catch (const std::exception&) {
+        return false;  // no file, no tombstones
+    }
+}
+
+// Appends a row with the cells `dateCell`, `category` and `description` to the events file
+// at `eventsPath`, in the order of its header, and with the same linebreaks. A new or empty
+// file gets a header first. Returns `false` and prints a message on failure.
+bool appendEventRow(const std::filesystem::path& eventsPath, std::string_view dateCell,
+                    std::string_view category, std::string_view description) {
+    try {
+        std::vector<std::string> header{"date", "category", "description"};
+        EventColumns columns{0, 1, 2};
+        bool hasCR{rapidcsv::SeparatorParams{}.mHasCR};
+        bool isNew{true};
+
+        std::error_code error;
+        if (std::filesystem::file_size(eventsPath, error) > 0 && !error) {
+            rapidcsv::RowReader reader{eventsPath.string()};
+            const auto found = reader.ReadRow(header) ? findEventColumns(header) : std::nullopt;
+            if (!found.has_value()) {
+                std::cerr << "expected the columns date, category and description in " << eventsPath.string() << '\n';
+                return false;
+            }
+            columns = found.value();
+            hasCR = reader.HasCR();
+            isNew = false;
+        }
+
+        std::vector<std::string> row(header.size());
+        row[columns.date] = dateCell;
+        row[columns.category] = category;
+        row[columns.description] = description;
+
+        // The header and the row go out in one write to the end of the file.
+        rapidcsv::RowWriter writer{eventsPath.string(), true, rapidcsv::SeparatorParams{',', false, hasCR}};
+        writer.SetQuoteRule(rapidcsv::RowWriter::QuoteRule::WhenNeeded);  // like a person editing the file would
+        if (isNew) {
+            writer.WriteRow(header);
+        }
+        writer.WriteRow(row);
+        writer.Close();
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "unable to write to " << eventsPath.string() << ": " << e.what() << '\n';
+        return false;
+    }
+}
+
+}  // namespace
+
+std::optional<EventColumns> findEventColumns(const std::vector<std::string>& header) {
+    auto findColumn = [&header](std::string_view name) {
+        return static_cast<std::size_t>(std::find(header.begin(), header.end(), name) - header.begin());
+    };
+    const EventColumns columns{findColumn("date"), findColumn("category"), findColumn("description")};
+    if (columns.date == header.size() || columns.category == header.size() || columns.description == header.size()) {
+        return std::nullopt;
+    }
+    return columns;
+}
+
+std::string_view getCell(const std::vector<std::string>& row, std::size_t column) {
+    return column < row.size() ? std::string_view{row[column]} : std::string_view{};
+}
+
+std::optional<std::chrono::year_month_day> parseTombstoneDate(std::string_view cell) {
+    if (!cell.starts_with(tombstoneMarker)) {
+        return std::nullopt;
+    }
+    const auto result = parseIsoDate(cell.substr(tombstoneMarker.size()));
+    if (!result) {
+        return std::nullopt;
+    }
+    return result.date;
+}
+
+void Tombstones::add(const std::chrono::year_month_day& date, std::string_view category, std::string_view description,
+                     std::size_t eventsBefore) {
+    const auto day = getDayNumber(date);
+    auto& tombstone = tombstones.emplace_back(Tombstone{{}, eventsBefore});
+    makeEventKey(tombstone.key, day, category, description);
+    days.insert(day);
+}
+
+std::size_t Tombstones::deleteFrom(EventStore& events) const {
+    if (tombstones.empty()) {
+        return 0;
+    }
+
+    // The events each tombstone could delete, in store order, and how many of them are deleted.
+    struct Candidates {
+        std::vector<std::size_t> indexes;
+        std::size_t deleted{0};
+    };
+    std::unordered_map<std::string, Candidates> candidates;
+    for (const auto& tombstone : tombstones) {
+        candidates.try_emplace(tombstone.key);
+    }
+
+    // In file order, so the last tombstone has the most events before it.
+    const auto eventCount = std::min(tombstones.back().eventsBefore, events.size());
+    const auto dayNumbers = events.getDayNumbers();
+    std::string key;
+    for (std::size_t i{0}; i < eventCount; i++) {
+        if (!days.contains(dayNumbers[i])) {
+            continue;
+        }
+        makeEventKey(key, dayNumbers[i], events.getCategory(i), events.getDescription(i));
+        if (auto found = candidates.find(key); found != candidates.end()) {
+            found->second.indexes.push_back(i);
+        }
+    }
+
+    std::vector<std::size_t> deleted;
+    for (const auto& tombstone : tombstones) {
+        auto& candidate = candidates.find(tombstone.key)->second;
+        if (candidate.deleted < candidate.indexes.size()
+            && candidate.indexes[candidate.deleted] < tombstone.eventsBefore) {
+            deleted.push_back(candidate.indexes[candidate.deleted++]);
+        }
+    }
+    std::sort(deleted.begin(), deleted.end());
+    events.remove(deleted);
+    return deleted.size();
+}
+
+void TombstoneFilter::add(const std::chrono::year_month_day& date, std::string_view category,
+                          std::string_view description) {
+    const auto day = getDayNumber(date);
+    makeEventKey(key, day, category, description);
+    counts[key].remaining++;
+    days.insert(day);
+}
+
+// An event is deleted by the first later tombstone not taken by an earlier event,
+// so it is deleted exactly when there are more tombstones to come than are taken.
+bool TombstoneFilter::isDeleted(const std::chrono::year_month_day& date, std::string_view category,
+                                std::string_view description) {
+    auto* found = find(date, category, description);
+    if (found == nullptr || found->remaining <= found->taken) {
+        return false;
+    }
+    found->taken++;
+    return true;
+}
+
+void TombstoneFilter::pass(const std::chrono::year_month_day& date, std::string_view category,
+                           std::string_view description) {
+    if (auto* found = find(date, category, description); found != nullptr && found->remaining > 0) {
+        found->remaining--;
+        if (found->taken > 0) {
+            found->taken--;  // this one was taken by an earlier event, otherwise it deletes nothing
+        }
+    }
+}
+
+TombstoneFilter::Counts* TombstoneFilter::find(const std::chrono::year_month_day& date, std::string_view category,
+                                               std::string_view description) {
+    const auto day = getDayNumber(date);
+    if (!days.contains(day)) {
+        return nullptr;
+    }
+    makeEventKey(key, day, category, description);
+    const auto found = counts.find(key);
+    return found != counts.end() ? &found->second : nullptr;
+}
+
+TombstoneFilter readTombstones(const std::filesystem::path& eventsPath) {
+    TombstoneFilter filter;
+    if (!containsTombstoneMarker(eventsPath)) {
+        return filter;
+    }
+
+    rapidcsv::RowReader reader{eventsPath.string()};
+    std::vector<std::string> row;
+    const auto columns = reader.ReadRow(row) ? findEventColumns(row) : std::nullopt;
+    if (!columns.has_value()) {
+        return filter;
+    }
+    while (reader.ReadRow(row)) {
+        if (const auto date = parseTombstoneDate(getCell(row, columns->date))) {
+            filter.add(date.value(), getCell(row, columns->category), getCell(row, columns->description));
+        }
+    }
+    return filter;
+}
+
+bool appendEvent(const std::filesystem::path& eventsPath, const std::chrono::year_month_day& date,
+                 std::string_view category, std::string_view description) {
+    std::string dateCell(isoDateLength, '0');
+    formatIsoDate(date, dateCell.data());
+    return appendEventRow(eventsPath, dateCell, category, description);
+}
+
+bool appendTombstone(const std::filesystem::path& eventsPath, const std::chrono::year_month_day& date,
+                     std::string_view category, std::string_view description) {
+    return appendEventRow(eventsPath, getTombstoneDate(date), category, description);
+}
+
+bool shouldCompact(std::size_t rowCount, std::size_t eventCount, std::size_t badDateRowCount) {
+    const auto liveRows = eventCount + badDateRowCount;
+    const auto deadRows = rowCount - std::min(rowCount, liveRows);
+    return deadRows >= minDeadRowsToCompact && deadRows * deadRowShareToCompact >= rowCount;
+}
+
+bool compactEvents(const std::filesystem::path& eventsPath) {
+    const auto before = getCsvFingerprint(eventsPath);
+    auto tombstones = readTombstones(eventsPath);
+    if (!before.has_value() || tombstones.empty()) {
+        return true;  // nothing to leave out
+    }
+
+    try {
+        // The rows that are kept are copied byte for byte, so compacting changes nothing else.
+        const rapidcsv::MappedFile file{eventsPath.string()};
+        const std::string_view contents{file.Data(), file.Size()};
+        rapidcsv::RowReader reader{eventsPath.string()};
+        std::vector<std::string> row;
+        const auto columns = reader.ReadRow(row) ? findEventColumns(row) : std::nullopt;
+        if (!columns.has_value()) {
+            std::cerr << "expected the columns date, category and description in " << eventsPath.string() << '\n';
+            return false;
+        }
+
+        rapidcsv::RowWriter writer{eventsPath.string()};
+        auto rowStart = reader.GetOffset();
+        writer.WriteRaw(contents.substr(0, std::min(rowStart, contents.size())));  // the header
+        for (; reader.ReadRow(row); rowStart = reader.GetOffset()) {
+            const auto dateCell = getCell(row, columns->date);
+            const auto category = getCell(row, columns->category);
+            const auto description = getCell(row, columns->description);
+            if (const auto deleted = parseTombstoneDate(dateCell)) {
+                tombstones.pass(deleted.value(), category, description);
+                continue;
+            }
+            // Rows with bad dates are kept as they are, for the user to fix.
+            const auto date = parseIsoDate(dateCell);
+            if (date && tombstones.isDeleted(date.date, category, description)) {
+                continue;
+            }
+            if (reader.GetOffset() > contents.size()) {
+                break;  // read past the mapping, so the file grew and is left alone below
+            }
+            writer.WriteRaw(contents.substr(rowStart, reader.GetOffset() - rowStart));
+        }
+
+        // Rows appended while compacting would be lost, so leave the file alone then.
+        // The writer removes its temporary file when it is not closed.
+        if (getCsvFingerprint(eventsPath) != before) {
+            std::cerr << eventsPath.string() << " changed while it was being compacted, so it was left as it was\n";
+            return false;
+        }
+        writer.Close();
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "unable to compact " << eventsPath.string() << ": " << e.what() << '\n';
+        return false;
+    }
+}
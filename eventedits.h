@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "eventstore.h"
+
+// Events are added and deleted by appending rows to the events file, so an edit
+// never rewrites the whole file. Deleting an event appends a tombstone: a copy of
+// the event's row with the date marked as deleted, like `deleted:2020-12-15`.
+// A tombstone deletes the first event before it in the file with the same date,
+// category and description that no other tombstone has deleted already; if there
+// is no such event, it deletes nothing. Once tombstones and the events they delete
+// take up a good part of the file, it is compacted: rewritten without them.
+
+// Where the date, category and description columns are in the rows of an events file.
+struct EventColumns {
+    std::size_t date;
+    std::size_t category;
+    std::size_t description;
+};
+
+// Finds the event columns in the `header` row of an events file,
+// or returns `std::nullopt` if one of them is missing.
+std::optional<EventColumns> findEventColumns(const std::vector<std::string>& header);
+
+// Returns the cell in `column` of `row`, or an empty string if the row is too short.
+std::string_view getCell(const std::vector<std::string>& row, std::size_t column);
+
+// Returns the date of the deleted event if `cell` is the date cell of a tombstone.
+std::optional<std::chrono::year_month_day> parseTombstoneDate(std::string_view cell);
+
+// Tombstones read together with the events before them into an `EventStore`,
+// so that the deleted events can be taken out of it afterwards.
+class Tombstones {
+public:
+    // Adds a tombstone that comes after the first `eventsBefore` events of the store.
+    // Tombstones must be added in file order.
+    void add(const std::chrono::year_month_day& date, std::string_view category, std::string_view description,
+             std::size_t eventsBefore);
+
+    bool empty() const { return tombstones.empty(); }
+
+    // Removes the events deleted by the tombstones from `events` and returns how many there were.
+    // Only the events on the dates of the tombstones are compared in full.
+    std::size_t deleteFrom(EventStore& events) const;
+
+private:
+    struct Tombstone {
+        std::string key;  // the date, category and description in one string
+        std::size_t eventsBefore;
+    };
+    std::vector<Tombstone> tombstones;
+    std::unordered_set<EventStore::DayNumber> days;
+};
+
+// Decides which events are deleted while the events file is read one row at a time,
+// from the start. A tombstone comes after the event it deletes, so all the tombstones
+// in the file must be added first; `readTombstones` does that.
+class TombstoneFilter {
+public:
+    void add(const std::chrono::year_month_day& date, std::string_view category, std::string_view description);
+
+    bool empty() const { return counts.empty(); }
+
+    // Call for each event row, in file order. Returns `true` if a later tombstone deletes the event.
+    bool isDeleted(const std::chrono::year_month_day& date, std::string_view category, std::string_view description);
+
+    // Call for each tombstone row, in file order.
+    void pass(const std::chrono::year_month_day& date, std::string_view category, std::string_view description);
+
+private:
+    // For the events with one date, category and description: the tombstones for them
+    // not read yet, and how many of those are taken by events already deleted.
+    struct Counts {
+        std::size_t remaining{0};
+        std::size_t taken{0};
+    };
+    Counts* find(const std::chrono::year_month_day& date, std::string_view category, std::string_view description);
+
+    std::unordered_map<std::string, Counts> counts;
+    std::unordered_set<EventStore::DayNumber> days;
+    std::string key;  // reused for lookups
+};
+
+// Reads all the tombstones in the events file at `eventsPath`. Files without the
+// tombstone marker anywhere in them are not parsed at all.
+TombstoneFilter readTombstones(const std::filesystem::path& eventsPath);
+
+// Appends an event to the end of the events file at `eventsPath`, creating the file
+// with a header if it does not exist yet. Returns `false` and prints a message on failure.
+bool appendEvent(const std::filesystem::path& eventsPath, const std::chrono::year_month_day& date,
+                 std::string_view category, std::string_view description);
+
+// Appends a tombstone for an event to the end of the events file at `eventsPath`.
+// Returns `false` and prints a message on failure.
+bool appendTombstone(const std::filesystem::path& eventsPath, const std::chrono::year_month_day& date,
+                     std::string_view category, std::string_view description);
+
+// Returns `true` if an events file with `rowCount` data rows, of which `eventCount` are
+// events still shown and `badDateRowCount` have bad dates, has enough dead rows to be worth
+// compacting. Only tombstones and the events they delete are dead: compacting keeps the
+// rows with bad dates, so counting them would compact again on every delete.
+bool shouldCompact(std::size_t rowCount, std::size_t eventCount, std::size_t badDateRowCount);
+
+// Rewrites the events file at `eventsPath` without the tombstones and the events they delete.
+// The new file replaces the old one in one rename, and only if nothing was added to it
+// meanwhile. Returns `false` and prints a message if the file was not compacted.
+bool compactEvents(const std::filesystem::path& eventsPath);
@@ -0,0 +1,143 @@
+#include "eventstore.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+std::chrono::year_month_day EventRef::getTimestamp() const {
+    return std::chrono::year_month_day{store->getDay(index)};
+}
+
+std::chrono::sys_days EventRef::getDay() const {
+    return store->getDay(index);
+}
+
+CategoryId EventRef::getCategoryId() const {
+    return store->getCategoryId(index);
+}
+
+std::string_view EventRef::getCategory() const {
+    return store->getCategory(index);
+}
+
+std::string_view EventRef::getDescription() const {
+    return store->getDescription(index);
+}
+
+EventStore::EventStore(const EventStore& other) :
+        columns(other.columns), backing(other.backing),
+        days(other.days), categoryIds(other.categoryIds),
+        descriptionArena(other.descriptionArena), descriptionOffsets(other.descriptionOffsets) {
+    if (!backing) {
+        refresh();
+    }
+}
+
+EventStore::EventStore(EventStore&& other) noexcept :
+        columns(other.columns), backing(std::move(other.backing)),
+        days(std::move(other.days)), categoryIds(std::move(other.categoryIds)),
+        descriptionArena(std::move(other.descriptionArena)), descriptionOffsets(std::move(other.descriptionOffsets)) {
+    if (!backing) {
+        refresh();  // a short description arena does not move along with its string
+    }
+    other.descriptionOffsets.assign(1, 0);
+    other.refresh();
+}
+
+EventStore& EventStore::operator=(EventStore other) noexcept {
+    columns = other.columns;
+    backing = std::move(other.backing);
+    days = std::move(other.days);
+    categoryIds = std::move(other.categoryIds);
+    descriptionArena = std::move(other.descriptionArena);
+    descriptionOffsets = std::move(other.descriptionOffsets);
+    if (!backing) {
+        refresh();
+    }
+    return *this;
+}
+
+EventStore EventStore::borrow(const Columns& columns, std::shared_ptr<const void> backing) {
+    EventStore store;
+    store.columns = columns;
+    store.backing = std::move(backing);
+    return store;
+}
+
+void EventStore::reserve(std::size_t count, std::size_t descriptionBytes) {
+    own();
+    days.reserve(count);
+    categoryIds.reserve(count);
+    descriptionOffsets.reserve(count + 1);
+    descriptionArena.reserve(descriptionBytes);
+    refresh();
+}
+
+void EventStore::add(const std::chrono::year_month_day& date, std::string_view category, std::string_view description) {
+    own();
+    if (descriptionArena.size() + description.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("event descriptions exceed 4 GiB");
+    }
+
+    days.push_back(std::chrono::sys_days{date}.time_since_epoch().count());
+    categoryIds.push_back(getCategoryTable().intern(category));
+    descriptionArena.append(description);
+    descriptionOffsets.push_back(static_cast<std::uint32_t>(descriptionArena.size()));
+    refresh();
+}
+
+void EventStore::remove(std::span<const std::size_t> indexes) {
+    if (indexes.empty()) {
+        return;
+    }
+    own();
+
+    // Slide the events that stay over the removed ones, descriptions included.
+    std::size_t kept{indexes.front()};
+    std::size_t descriptionEnd{descriptionOffsets[kept]};
+    auto removed = indexes.begin();
+    for (std::size_t i{kept}; i < days.size(); i++) {
+        if (removed != indexes.end() && *removed == i) {
+            ++removed;
+            continue;
+        }
+        const auto begin = descriptionOffsets[i];
+        const auto length = descriptionOffsets[i + 1] - begin;
+        std::memmove(descriptionArena.data() + descriptionEnd, descriptionArena.data() + begin, length);
+        descriptionEnd += length;
+        days[kept] = days[i];
+        categoryIds[kept] = categoryIds[i];
+        descriptionOffsets[kept + 1] = static_cast<std::uint32_t>(descriptionEnd);
+        kept++;
+    }
+
+    days.resize(kept);
+    categoryIds.resize(kept);
+    descriptionOffsets.resize(kept + 1);
+    descriptionArena.resize(descriptionEnd);
+    refresh();
+}
+
+std::string_view EventStore::getDescription(std::size_t i) const {
+    const auto begin = columns.descriptionOffsets[i];
+    const auto end = columns.descriptionOffsets[i + 1];
+    return columns.descriptionArena.substr(begin, end - begin);
+}
+
+// Copies borrowed columns into the store's own vectors, so that they can be changed.
+void EventStore::own() {
+    if (!backing) {
+        return;
+    }
+    days.assign(columns.days.begin(), columns.days.end());
+    categoryIds.assign(columns.categoryIds.begin(), columns.categoryIds.end());
+    descriptionOffsets.assign(columns.descriptionOffsets.begin(), columns.descriptionOffsets.end());
+    descriptionArena.assign(columns.descriptionArena);
+    backing.reset();
+    refresh();
+}
+
+// Points the column views at the store's own vectors again after they have changed.
+void EventStore::refresh() {
+    columns = Columns{days, categoryIds, descriptionOffsets, descriptionArena};
+}
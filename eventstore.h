@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "categories.h"
+
+class EventStore;
+
+// A lightweight, non-owning reference to one event in an `EventStore`.
+// Has the same getters as `Event`, so it can be printed the same way.
+class EventRef {
+public:
+    EventRef(const EventStore& s, std::size_t i) : store(&s), index(i) { }
+
+    std::chrono::year_month_day getTimestamp() const;
+    std::chrono::sys_days getDay() const;
+    CategoryId getCategoryId() const;
+    std::string_view getCategory() const;
+    std::string_view getDescription() const;
+    std::size_t getIndex() const { return index; }
+
+private:
+    const EventStore* store;
+    std::size_t index;
+};
+
+// Stores events column by column instead of as separate objects:
+// the dates are a contiguous column of day numbers (days since 1970-01-01),
+// the categories are ids interned in the shared `CategoryTable`,
+// and all the descriptions share one character buffer.
+// The columns can also be borrowed from elsewhere, like a memory-mapped cache file.
+class EventStore {
+public:
+    using DayNumber = std::int32_t;
+
+    // Read-only views of the columns.
+    struct Columns {
+        std::span<const DayNumber> days;
+        std::span<const CategoryId> categoryIds;
+        std::span<const std::uint32_t> descriptionOffsets;  // event i is [offsets[i], offsets[i + 1])
+        std::string_view descriptionArena;
+    };
+
+    // Iterates over the events in insertion order, yielding `EventRef`s.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = EventRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = EventRef;
+
+        const_iterator() = default;
+        const_iterator(const EventStore* s, std::size_t i) : store(s), index(i) { }
+
+        EventRef operator*() const { return EventRef{*store, index}; }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++index; return old; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+
+    private:
+        const EventStore* store{nullptr};
+        std::size_t index{0};
+    };
+
+    EventStore() { refresh(); }
+    EventStore(const EventStore& other);
+    EventStore(EventStore&& other) noexcept;
+    EventStore& operator=(EventStore other) noexcept;
+
+    // Creates a store that reads `columns` from memory kept alive by `backing`,
+    // without copying them. The category ids must be valid in the shared `CategoryTable`.
+    // The columns are copied only if events are added to the store later.
+    static EventStore borrow(const Columns& columns, std::shared_ptr<const void> backing);
+
+    // Reserves room for `count` events with `descriptionBytes` characters of descriptions.
+    void reserve(std::size_t count, std::size_t descriptionBytes);
+
+    // Appends an event. The category is interned and the description is copied into the store.
+    void add(const std::chrono::year_month_day& date, std::string_view category, std::string_view description);
+
+    // Removes the events at `indexes`, which must be in increasing order.
+    // The other events keep their order, and the columns are compacted in one pass.
+    void remove(std::span<const std::size_t> indexes);
+
+    std::size_t size() const { return columns.days.size(); }
+    bool empty() const { return columns.days.empty(); }
+
+    EventRef operator[](std::size_t i) const { return EventRef{*this, i}; }
+    const_iterator begin() const { return const_iterator{this, 0}; }
+    const_iterator end() const { return const_iterator{this, size()}; }
+
+    // All the columns, for saving them elsewhere.
+    const Columns& getColumns() const { return columns; }
+
+    // The whole date column, for scans that only look at the dates.
+    std::span<const DayNumber> getDayNumbers() const { return columns.days; }
+
+    // The whole category column, for filtering and grouping by category id.
+    std::span<const CategoryId> getCategoryIds() const { return columns.categoryIds; }
+
+    std::chrono::sys_days getDay(std::size_t i) const {
+        return std::chrono::sys_days{std::chrono::days{columns.days[i]}};
+    }
+    CategoryId getCategoryId(std::size_t i) const { return columns.categoryIds[i]; }
+    std::string_view getCategory(std::size_t i) const { return getCategoryTable().getName(columns.categoryIds[i]); }
+    std::string_view getDescription(std::size_t i) const;
+
+private:
+    void own();
+    void refresh();
+
+    Columns columns;  // views of the vectors below, or of memory kept alive by `backing`
+    std::shared_ptr<const void> backing;
+
+    std::vector<DayNumber> days;
+    std::vector<CategoryId> categoryIds;
+    std::string descriptionArena;
+    std::vector<std::uint32_t> descriptionOffsets{0};
+};
@@ -0,0 +1,154 @@
+#include "output.h"
+
+#include <cerrno>
+#include <cstring>  // for std::memcpy
+
+#if defined(_WIN32)
+#include <cstdio>   // for std::fwrite
+#else
+#include <climits>  // for IOV_MAX
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Texts at least this long are worth writing from where they are in `Mode::Gather`.
+constexpr std::size_t gatherThreshold = 128;
+
+#if defined(_WIN32)
+void writeAll(const char* data, std::size_t size) {
+    std::fwrite(data, 1, size, stdout);
+    std::fflush(stdout);
+}
+#else
+#if defined(IOV_MAX)
+constexpr std::size_t maxPieces = IOV_MAX;
+#else
+constexpr std::size_t maxPieces = 1024;
+#endif
+
+void writeAll(const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // nowhere to report the error, the reader has probably gone away
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+// Writes `count` iovecs, resuming after partial writes.
+void writeAll(iovec* iov, std::size_t count) {
+    while (count > 0) {
+        const auto batch = static_cast<int>(count < maxPieces ? count : maxPieces);
+        auto written = ::writev(STDOUT_FILENO, iov, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        while (count > 0 && static_cast<std::size_t>(written) >= iov->iov_len) {
+            written -= static_cast<ssize_t>(iov->iov_len);
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= static_cast<std::size_t>(written);
+        }
+    }
+}
+#endif
+
+}  // namespace
+
+OutputBuffer::OutputBuffer(Mode m, std::size_t capacity, std::pmr::memory_resource* resource)
+    : mode(m), buffer(capacity, resource), pieces(resource) {
+#if defined(_WIN32)
+    mode = Mode::Copy;  // no writev() here
+#endif
+}
+
+OutputBuffer::OutputBuffer(std::string& t, std::size_t capacity)
+    : mode(Mode::Copy), target(&t), buffer(capacity) {
+}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::append(std::string_view text) {
+    if (text.size() > buffer.size()) {
+        flush();
+        write(text.data(), text.size());
+        return;
+    }
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    used += text.size();
+}
+
+void OutputBuffer::append(char c) {
+    *reserve(1) = c;
+    used++;
+}
+
+void OutputBuffer::appendStable(std::string_view text) {
+    if (mode != Mode::Gather || text.size() < gatherThreshold) {
+        append(text);
+        return;
+    }
+    closeRun();
+    pieces.push_back({text.data(), text.size()});
+}
+
+char* OutputBuffer::reserve(std::size_t count) {
+    if (buffer.size() - used < count) {
+        flush();
+        if (buffer.size() < count) {
+            buffer.resize(count);
+        }
+    }
+    return buffer.data() + used;
+}
+
+void OutputBuffer::closeRun() {
+    if (used > runStart) {
+        pieces.push_back({buffer.data() + runStart, used - runStart});
+        runStart = used;
+    }
+}
+
+void OutputBuffer::flush() {
+#if !defined(_WIN32)
+    if (mode == Mode::Gather) {
+        closeRun();
+        std::vector<iovec> iov;
+        iov.reserve(pieces.size());
+        for (const auto& piece : pieces) {
+            iov.push_back({const_cast<char*>(piece.data), piece.size});
+        }
+        writeAll(iov.data(), iov.size());
+        pieces.clear();
+        used = 0;
+        runStart = 0;
+        return;
+    }
+#endif
+    write(buffer.data(), used);
+    used = 0;
+}
+
+void OutputBuffer::write(const char* data, std::size_t size) {
+    if (target != nullptr) {
+        target->append(data, size);
+    }
+    else {
+        writeAll(data, size);
+    }
+}
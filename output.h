@@ -0,0 +1,75 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Collects output in a large reusable buffer and writes it to standard output
+// only when the buffer fills up, when `flush` is called, or when the buffer
+// is destroyed. Anything printed with `std::cout` must be flushed before
+// using an `OutputBuffer`, which writes to the file descriptor directly.
+class OutputBuffer {
+public:
+    enum class Mode {
+        Copy,   // copy everything into the buffer and write it with write()
+        Gather  // let long texts stay where they are and write them with writev()
+    };
+
+    // The buffer and the list of pending pieces are allocated from `resource`.
+    explicit OutputBuffer(Mode mode = Mode::Copy, std::size_t capacity = 256 * 1024,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Collects the output into `target` instead of writing it to standard output.
+    explicit OutputBuffer(std::string& target, std::size_t capacity = 64 * 1024);
+
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    // Copies `text` into the buffer.
+    void append(std::string_view text);
+    void append(char c);
+
+    // Like `append`, but in `Mode::Gather` a long `text` is written from where it is
+    // instead of being copied. Then `text` must stay valid until the next flush.
+    void appendStable(std::string_view text);
+
+    // Formats `value` in decimal straight into the buffer.
+    template <std::integral T>
+    void appendNumber(T value) {
+        reserve(24);  // enough for any 64-bit integer
+        const auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+        used = static_cast<std::size_t>(result.ptr - buffer.data());
+    }
+
+    // Makes room for `count` more characters, flushing if needed, and returns
+    // where to write them. Call `commit` afterwards with the number actually written.
+    char* reserve(std::size_t count);
+    void commit(std::size_t count) { used += count; }
+
+    // Writes out everything collected so far.
+    void flush();
+
+private:
+    void closeRun();
+    void write(const char* data, std::size_t size);
+
+    Mode mode;
+    std::string* target{nullptr};  // where the output goes instead of standard output, if set
+    std::pmr::vector<char> buffer;
+    std::size_t used{0};
+
+    // Pieces waiting to be written in `Mode::Gather`, in order. They point
+    // either into `buffer` or to the caller's stable texts.
+    struct Piece {
+        const char* data;
+        std::size_t size;
+    };
+    std::pmr::vector<Piece> pieces;
+    std::size_t runStart{0};  // start of the buffer contents not yet in `pieces`
+};
@@ -14,19 +14,33 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <clocale>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #ifdef HAS_CODECVT
 #include <codecvt>
 #include <locale>
 #endif
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <limits>
-#include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
@@ -35,6 +49,23 @@
 typedef SSIZE_T ssize_t;
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RAPIDCSV_HAS_SSE2
+#include <emmintrin.h>
+// GCC and Clang can build an AVX2 kernel for runtime dispatch, MSVC only when targeting AVX2
+#if (defined(__GNUC__) && !defined(_MSC_VER)) || defined(__AVX2__)
+#define RAPIDCSV_HAS_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace rapidcsv
 {
 #if defined(_MSC_VER)
@@ -108,6 +139,17 @@ namespace rapidcsv
     }
   };
 
+  /**
+   * @brief     Whether the Converter class itself converts values of type T, rather than a
+   *            specialization provided by the user.
+   */
+  template<typename T>
+  constexpr bool IsBuiltInConvertible =
+    std::is_same_v<T, int> || std::is_same_v<T, long> || std::is_same_v<T, long long> ||
+    std::is_same_v<T, unsigned> || std::is_same_v<T, unsigned long> || std::is_same_v<T, unsigned long long> ||
+    std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, long double> ||
+    std::is_same_v<T, char>;
+
   /**
    * @brief     Class providing conversion to/from numerical datatypes and strings. Only
    *            intended for rapidcsv internal usage, but exposed externally to allow
@@ -125,6 +167,12 @@ namespace rapidcsv
     Converter(const ConverterParams& pConverterParams)
       : mConverterParams(pConverterParams)
     {
+      if constexpr (std::is_floating_point_v<T>)
+      {
+        // std::from_chars always uses '.', which only matches the locale if the locale does too
+        const char* decimalPoint = std::localeconv()->decimal_point;
+        mDecimalPointIsDot = (decimalPoint != nullptr) && (std::strcmp(decimalPoint, ".") == 0);
+      }
     }
 
     /**
@@ -134,20 +182,29 @@ namespace rapidcsv
      */
     void ToStr(const T& pVal, std::string& pStr) const
     {
-      if (typeid(T) == typeid(int) ||
-          typeid(T) == typeid(long) ||
-          typeid(T) == typeid(long long) ||
-          typeid(T) == typeid(unsigned) ||
-          typeid(T) == typeid(unsigned long) ||
-          typeid(T) == typeid(unsigned long long) ||
-          typeid(T) == typeid(float) ||
-          typeid(T) == typeid(double) ||
-          typeid(T) == typeid(long double) ||
-          typeid(T) == typeid(char))
+      if constexpr (std::is_same_v<T, char>)
+      {
+        pStr.assign(1, pVal);
+      }
+      else if constexpr (std::is_integral_v<T> && IsBuiltInConvertible<T>)
+      {
+        char buffer[24];
+        const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), pVal);
+        pStr.assign(buffer, result.ptr);
+      }
+      else if constexpr (std::is_floating_point_v<T>)
       {
+#if defined(__cpp_lib_to_chars)
+        // same as the default std::ostream format, i.e. printf("%g")
+        char buffer[64];
+        const std::to_chars_result result =
+          std::to_chars(buffer, buffer + sizeof(buffer), pVal, std::chars_format::general, 6);
+        pStr.assign(buffer, result.ptr);
+#else
         std::ostringstream out;
         out << pVal;
         pStr = out.str();
+#endif
       }
       else
       {
@@ -162,114 +219,203 @@ namespace rapidcsv
      */
     void ToVal(const std::string& pStr, T& pVal) const
     {
-      try
+      ViewToVal(pStr, pVal);
+    }
+
+    /**
+     * @brief   Converts string holding a numerical value to numerical datatype representation,
+     *          like ToVal(), but without needing a std::string.
+     * @param   pStr                  string holding the value
+     * @param   pVal                  numerical value
+     */
+    void ViewToVal(const std::string_view pStr, T& pVal) const
+    {
+      const std::errc error = TryToVal(pStr, pVal);
+      if (error == std::errc())
       {
-        if (typeid(T) == typeid(int))
-        {
-          pVal = static_cast<T>(std::stoi(pStr));
-          return;
-        }
-        else if (typeid(T) == typeid(long))
-        {
-          pVal = static_cast<T>(std::stol(pStr));
-          return;
-        }
-        else if (typeid(T) == typeid(long long))
-        {
-          pVal = static_cast<T>(std::stoll(pStr));
-          return;
-        }
-        else if (typeid(T) == typeid(unsigned))
-        {
-          pVal = static_cast<T>(std::stoul(pStr));
-          return;
-        }
-        else if (typeid(T) == typeid(unsigned long))
-        {
-          pVal = static_cast<T>(std::stoul(pStr));
-          return;
-        }
-        else if (typeid(T) == typeid(unsigned long long))
-        {
-          pVal = static_cast<T>(std::stoull(pStr));
-          return;
-        }
+        return;
       }
-      catch (...)
+      if (error == std::errc::not_supported)
+      {
+        throw no_converter();
+      }
+      if (mConverterParams.mHasDefaultConverter)
       {
-        if (!mConverterParams.mHasDefaultConverter)
+        if constexpr (std::is_floating_point_v<T>)
         {
-          throw;
+          pVal = static_cast<T>(mConverterParams.mDefaultFloat);
         }
-        else
+        else if constexpr (std::is_integral_v<T>)
         {
           pVal = static_cast<T>(mConverterParams.mDefaultInteger);
-          return;
         }
+        return;
+      }
+      if (error == std::errc::result_out_of_range)
+      {
+        throw std::out_of_range("rapidcsv: value out of range: " + std::string(pStr));
       }
+      throw std::invalid_argument("rapidcsv: no conversion: " + std::string(pStr));
+    }
 
-      try
+    /**
+     * @brief   Converts string holding a numerical value to numerical datatype representation,
+     *          reporting errors instead of throwing. Invalid values are not replaced with the
+     *          default values of ConverterParams, that is up to the caller.
+     * @param   pStr                  string holding the value
+     * @param   pVal                  numerical value, only set on success
+     * @returns std::errc() on success, std::errc::invalid_argument if pStr does not hold a
+     *          value of type T, std::errc::result_out_of_range if the value does not fit in T,
+     *          or std::errc::not_supported if type T is not supported.
+     */
+    std::errc TryToVal(const std::string_view pStr, T& pVal) const
+    {
+      if constexpr (std::is_same_v<T, char>)
       {
-        if (mConverterParams.mNumericLocale)
+        pVal = pStr.empty() ? '\0' : pStr[0];
+        return std::errc();
+      }
+      else if constexpr (std::is_integral_v<T> && IsBuiltInConvertible<T>)
+      {
+        // plain numbers take the fast path, anything else is parsed as std::stoi and others would
+        const std::from_chars_result result = std::from_chars(pStr.data(), pStr.data() + pStr.size(), pVal);
+        if ((result.ec == std::errc()) && (result.ptr == pStr.data() + pStr.size()))
         {
-          if (typeid(T) == typeid(float))
-          {
-            pVal = static_cast<T>(std::stof(pStr));
-            return;
-          }
-          else if (typeid(T) == typeid(double))
-          {
-            pVal = static_cast<T>(std::stod(pStr));
-            return;
-          }
-          else if (typeid(T) == typeid(long double))
-          {
-            pVal = static_cast<T>(std::stold(pStr));
-            return;
-          }
+          return std::errc();
         }
-        else
+        return ParseInteger(std::string(pStr), pVal);
+      }
+      else if constexpr (std::is_floating_point_v<T>)
+      {
+#if defined(__cpp_lib_to_chars)
+        if (IsPlainDecimal(pStr) && (mDecimalPointIsDot || !mConverterParams.mNumericLocale))
         {
-          if ((typeid(T) == typeid(float)) ||
-              (typeid(T) == typeid(double)) ||
-              (typeid(T) == typeid(long double)))
+          // subnormal values count as out of range in the standard library functions
+          T val = 0;
+          const std::from_chars_result result = std::from_chars(pStr.data(), pStr.data() + pStr.size(), val);
+          if ((result.ec == std::errc()) && (result.ptr == pStr.data() + pStr.size()) &&
+              (std::fpclassify(val) != FP_SUBNORMAL))
           {
-            std::istringstream iss(pStr);
-            iss >> pVal;
-            if (iss.fail() || iss.bad() || !iss.eof())
-            {
-              throw std::invalid_argument("istringstream: no conversion");
-            }
-            return;
+            pVal = val;
+            return std::errc();
           }
         }
+#endif
+        return ParseFloat(std::string(pStr), pVal);
       }
-      catch (...)
+      else
       {
-        if (!mConverterParams.mHasDefaultConverter)
-        {
-          throw;
-        }
-        else
+        (void)pStr;
+        (void)pVal;
+        return std::errc::not_supported;
+      }
+    }
+
+  private:
+    // Returns whether pStr starts like a number std::from_chars parses the same way as the
+    // standard library functions below, i.e. not with spaces, '+', "inf", "nan" or "0x".
+    static bool IsPlainDecimal(const std::string_view pStr)
+    {
+      size_t pos = (!pStr.empty() && (pStr[0] == '-')) ? 1 : 0;
+      return (pos < pStr.size()) && ((isdigit(static_cast<unsigned char>(pStr[pos])) != 0) || (pStr[pos] == '.')) &&
+             !((pStr[pos] == '0') && (pos + 1 < pStr.size()) && ((pStr[pos + 1] == 'x') || (pStr[pos + 1] == 'X')));
+    }
+
+    // Parses an integer like std::stoi, std::stol, std::stoll, std::stoul and std::stoull:
+    // leading spaces and trailing text are skipped, negative unsigned values wrap around.
+    static std::errc ParseInteger(const std::string& pStr, T& pVal)
+    {
+      const int savedErrno = errno;
+      errno = 0;
+      char* end = nullptr;
+      T val = 0;
+      bool inRange = true;
+      if constexpr (std::is_same_v<T, int>)
+      {
+        const long longVal = std::strtol(pStr.c_str(), &end, 10);
+        inRange = (longVal >= std::numeric_limits<int>::min()) && (longVal <= std::numeric_limits<int>::max());
+        val = static_cast<T>(longVal);
+      }
+      else if constexpr (std::is_same_v<T, long>)
+      {
+        val = std::strtol(pStr.c_str(), &end, 10);
+      }
+      else if constexpr (std::is_same_v<T, long long>)
+      {
+        val = std::strtoll(pStr.c_str(), &end, 10);
+      }
+      else if constexpr (std::is_same_v<T, unsigned> || std::is_same_v<T, unsigned long>)
+      {
+        val = static_cast<T>(std::strtoul(pStr.c_str(), &end, 10));
+      }
+      else
+      {
+        val = std::strtoull(pStr.c_str(), &end, 10);
+      }
+      const bool outOfRange = (errno == ERANGE) || !inRange;
+      errno = savedErrno;
+
+      if (end == pStr.c_str())
+      {
+        return std::errc::invalid_argument;
+      }
+      if (outOfRange)
+      {
+        return std::errc::result_out_of_range;
+      }
+      pVal = val;
+      return std::errc();
+    }
+
+    // Parses a floating-point value like std::stof, std::stod and std::stold when honoring
+    // LC_NUMERIC, otherwise like reading all of pStr from a std::istringstream.
+    std::errc ParseFloat(const std::string& pStr, T& pVal) const
+    {
+      T val = 0;
+      if (!mConverterParams.mNumericLocale)
+      {
+        std::istringstream iss(pStr);
+        iss >> val;
+        if (iss.fail() || iss.bad() || !iss.eof())
         {
-          pVal = static_cast<T>(mConverterParams.mDefaultFloat);
-          return;
+          return std::errc::invalid_argument;
         }
+        pVal = val;
+        return std::errc();
       }
 
-      if (typeid(T) == typeid(char))
+      const int savedErrno = errno;
+      errno = 0;
+      char* end = nullptr;
+      if constexpr (std::is_same_v<T, float>)
       {
-        pVal = static_cast<T>(pStr[0]);
-        return;
+        val = std::strtof(pStr.c_str(), &end);
+      }
+      else if constexpr (std::is_same_v<T, double>)
+      {
+        val = std::strtod(pStr.c_str(), &end);
       }
       else
       {
-        throw no_converter();
+        val = std::strtold(pStr.c_str(), &end);
+      }
+      const bool outOfRange = (errno == ERANGE);
+      errno = savedErrno;
+
+      if (end == pStr.c_str())
+      {
+        return std::errc::invalid_argument;
       }
+      if (outOfRange)
+      {
+        return std::errc::result_out_of_range;
+      }
+      pVal = val;
+      return std::errc();
     }
 
-  private:
     const ConverterParams& mConverterParams;
+    bool mDecimalPointIsDot = true;
   };
 
   /**
@@ -297,6 +443,57 @@ namespace rapidcsv
   template<typename T>
   using ConvFunc = std::function<void (const std::string & pStr, T & pVal)>;
 
+  /**
+   * @brief     Datastructure describing one column to extract with Document::GetColumns(): which
+   *            column, how to convert its cells and where to write the converted values.
+   */
+  template<typename T, typename F>
+  struct ColumnProjection
+  {
+    /**
+     * @brief   Constructor
+     * @param   pColumnName           specifies the column label name.
+     * @param   pOut                  specifies the buffer to write the values to, which must have
+     *                                room for one value per row.
+     * @param   pToVal                specifies the conversion function, called as
+     *                                pToVal(std::string_view, T&) for every cell.
+     */
+    ColumnProjection(const std::string& pColumnName, T* pOut, F pToVal)
+      : mColumnName(pColumnName)
+      , mOut(pOut)
+      , mToVal(pToVal)
+    {
+    }
+
+    /**
+     * @brief   specifies the column label name.
+     */
+    std::string mColumnName;
+
+    /**
+     * @brief   specifies the buffer to write the values to.
+     */
+    T* mOut;
+
+    /**
+     * @brief   specifies the conversion function.
+     */
+    F mToVal;
+  };
+
+  /**
+   * @brief   Create a ColumnProjection, deducing its types from the arguments.
+   * @param   pColumnName             column label name.
+   * @param   pOut                    buffer with room for one value per row.
+   * @param   pToVal                  conversion function, called as pToVal(std::string_view, T&).
+   * @returns column projection for Document::GetColumns().
+   */
+  template<typename T, typename F>
+  ColumnProjection<T, F> MakeColumnProjection(const std::string& pColumnName, T* pOut, F pToVal)
+  {
+    return ColumnProjection<T, F>(pColumnName, pOut, pToVal);
+  }
+
   /**
    * @brief     Datastructure holding parameters controlling which row and column should be
    *            treated as labels.
@@ -443,127 +640,1376 @@ namespace rapidcsv
   };
 
   /**
-   * @brief     Class representing a CSV document.
+   * @brief     Datastructure holding parameters controlling parallel parsing.
    */
-  class Document
+  struct ParallelParams
   {
-  public:
     /**
      * @brief   Constructor
-     * @param   pPath                 specifies the path of an existing CSV-file to populate the Document
-     *                                data with.
-     * @param   pLabelParams          specifies which row and column should be treated as labels.
-     * @param   pSeparatorParams      specifies which field and row separators should be used.
-     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
-     *                                handled.
-     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @param   pThreadCount          specifies how many threads to parse with, 0 meaning one per
+     *                                hardware thread. Default: 1
+     * @param   pMinChunkSize         specifies the minimum number of bytes for each thread to parse,
+     *                                so that small files are not split up. Default: 1 MiB
      */
-    explicit Document(const std::string& pPath = std::string(),
-                      const LabelParams& pLabelParams = LabelParams(),
-                      const SeparatorParams& pSeparatorParams = SeparatorParams(),
-                      const ConverterParams& pConverterParams = ConverterParams(),
-                      const LineReaderParams& pLineReaderParams = LineReaderParams())
-      : mPath(pPath)
-      , mLabelParams(pLabelParams)
-      , mSeparatorParams(pSeparatorParams)
-      , mConverterParams(pConverterParams)
-      , mLineReaderParams(pLineReaderParams)
-      , mData()
-      , mColumnNames()
-      , mRowNames()
+    explicit ParallelParams(const size_t pThreadCount = 1,
+                            const size_t pMinChunkSize = 1024 * 1024)
+      : mThreadCount(pThreadCount)
+      , mMinChunkSize(pMinChunkSize)
     {
-      if (!mPath.empty())
-      {
-        ReadCsv();
-      }
     }
 
     /**
-     * @brief   Constructor
-     * @param   pStream               specifies a binary input stream to read CSV data from.
-     * @param   pLabelParams          specifies which row and column should be treated as labels.
-     * @param   pSeparatorParams      specifies which field and row separators should be used.
-     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
-     *                                handled.
-     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @brief   specifies how many threads to parse with, 0 meaning one per hardware thread.
      */
-    explicit Document(std::istream& pStream,
-                      const LabelParams& pLabelParams = LabelParams(),
-                      const SeparatorParams& pSeparatorParams = SeparatorParams(),
-                      const ConverterParams& pConverterParams = ConverterParams(),
-                      const LineReaderParams& pLineReaderParams = LineReaderParams())
-      : mPath()
-      , mLabelParams(pLabelParams)
-      , mSeparatorParams(pSeparatorParams)
-      , mConverterParams(pConverterParams)
-      , mLineReaderParams(pLineReaderParams)
-      , mData()
-      , mColumnNames()
-      , mRowNames()
-    {
-      ReadCsv(pStream);
-    }
+    size_t mThreadCount;
 
     /**
-     * @brief   Read Document data from file.
-     * @param   pPath                 specifies the path of an existing CSV-file to populate the Document
-     *                                data with.
-     * @param   pLabelParams          specifies which row and column should be treated as labels.
-     * @param   pSeparatorParams      specifies which field and row separators should be used.
-     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
-     *                                handled.
-     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @brief   specifies the minimum number of bytes for each thread to parse.
      */
-    void Load(const std::string& pPath,
-              const LabelParams& pLabelParams = LabelParams(),
-              const SeparatorParams& pSeparatorParams = SeparatorParams(),
-              const ConverterParams& pConverterParams = ConverterParams(),
-              const LineReaderParams& pLineReaderParams = LineReaderParams())
-    {
-      mPath = pPath;
-      mLabelParams = pLabelParams;
-      mSeparatorParams = pSeparatorParams;
-      mConverterParams = pConverterParams;
-      mLineReaderParams = pLineReaderParams;
-      ReadCsv();
-    }
+    size_t mMinChunkSize;
+  };
 
+  /**
+   * @brief     Class holding a read-only view of a whole file. Uses mmap on POSIX platforms,
+   *            elsewhere the file contents are read into memory once.
+   */
+  class MappedFile
+  {
+  public:
     /**
-     * @brief   Read Document data from stream.
-     * @param   pStream               specifies a binary input stream to read CSV data from.
-     * @param   pLabelParams          specifies which row and column should be treated as labels.
-     * @param   pSeparatorParams      specifies which field and row separators should be used.
-     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
-     *                                handled.
-     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @brief   Constructor
+     * @param   pPath                 specifies the path of an existing file to map.
      */
-    void Load(std::istream& pStream,
-              const LabelParams& pLabelParams = LabelParams(),
-              const SeparatorParams& pSeparatorParams = SeparatorParams(),
-              const ConverterParams& pConverterParams = ConverterParams(),
-              const LineReaderParams& pLineReaderParams = LineReaderParams())
+    explicit MappedFile(const std::string& pPath)
     {
-      mPath = "";
-      mLabelParams = pLabelParams;
-      mSeparatorParams = pSeparatorParams;
-      mConverterParams = pConverterParams;
-      mLineReaderParams = pLineReaderParams;
-      ReadCsv(pStream);
+#if !defined(_WIN32)
+      const int fd = open(pPath.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+        throw std::ios_base::failure("unable to open file: " + pPath);
+      }
+
+      struct stat st;
+      if (fstat(fd, &st) != 0)
+      {
+        close(fd);
+        throw std::ios_base::failure("unable to stat file: " + pPath);
+      }
+
+      mSize = static_cast<size_t>(st.st_size);
+      if (mSize > 0)
+      {
+        void* addr = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+          close(fd);
+          throw std::ios_base::failure("unable to map file: " + pPath);
+        }
+        mData = static_cast<const char*>(addr);
+#if defined(POSIX_MADV_SEQUENTIAL)
+        posix_madvise(addr, mSize, POSIX_MADV_SEQUENTIAL);
+#endif
+      }
+      close(fd);
+#else
+      std::ifstream stream;
+      stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+      stream.open(pPath, std::ios::binary);
+      stream.seekg(0, std::ios::end);
+      mBuffer.resize(static_cast<size_t>(stream.tellg()));
+      stream.seekg(0, std::ios::beg);
+      if (!mBuffer.empty())
+      {
+        stream.read(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+      }
+      mData = mBuffer.data();
+      mSize = mBuffer.size();
+#endif
     }
 
-    /**
-     * @brief   Write Document data to file.
-     * @param   pPath                 optionally specifies the path where the CSV-file will be created
-     *                                (if not specified, the original path provided when creating or
-     *                                loading the Document data will be used).
-     */
-    void Save(const std::string& pPath = std::string())
+    ~MappedFile()
     {
-      if (!pPath.empty())
+#if !defined(_WIN32)
+      if (mData != nullptr)
       {
-        mPath = pPath;
+        munmap(const_cast<char*>(mData), mSize);
       }
-      WriteCsv();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief   Get pointer to the first byte of the file.
+     * @returns pointer to file data (nullptr for an empty file).
+     */
+    const char* Data() const
+    {
+      return mData;
+    }
+
+    /**
+     * @brief   Get size of the file.
+     * @returns file size in bytes.
+     */
+    size_t Size() const
+    {
+      return mSize;
+    }
+
+  private:
+    const char* mData = nullptr;
+    size_t mSize = 0;
+#if defined(_WIN32)
+    std::vector<char> mBuffer;
+#endif
+  };
+
+  /**
+   * @brief     Class finding the structural characters of CSV data, i.e. quotes, separators,
+   *            carriage returns and linebreaks, 64 bytes at a time. Each block of data is
+   *            classified into a bitmask with the best vector instructions the CPU supports
+   *            (AVX2 or SSE2, selected at runtime), so runs of ordinary characters can be
+   *            skipped in bulk. Only intended for rapidcsv internal usage.
+   */
+  class StructuralScanner
+  {
+  public:
+    /**
+     * @brief   Constructor
+     * @param   pBegin                specifies the start of the data to scan.
+     * @param   pEnd                  specifies the end of the data to scan.
+     * @param   pQuoteChar            specifies the quote character.
+     * @param   pSeparator            specifies the column separator.
+     */
+    StructuralScanner(const char* pBegin, const char* pEnd, const char pQuoteChar, const char pSeparator)
+      : mBegin(pBegin)
+      , mEnd(pEnd)
+      , mQuoteChar(pQuoteChar)
+      , mSeparator(pSeparator)
+      , mClassify(GetClassifier())
+    {
+    }
+
+    /**
+     * @brief   Find the next structural character.
+     * @param   pPos                  position in the data to search from, within [begin, end].
+     * @returns pointer to the first structural character at or after pPos, or the end of the
+     *          data if there is none.
+     */
+    const char* Next(const char* pPos)
+    {
+      if (pPos >= mEnd)
+      {
+        return mEnd;
+      }
+
+      if ((mBlock == nullptr) || (pPos < mBlock) || (pPos >= mBlock + sBlockSize))
+      {
+        LoadBlock(mBegin + (static_cast<size_t>(pPos - mBegin) & ~(sBlockSize - 1)));
+      }
+
+      uint64_t mask = mMask & (~uint64_t(0) << static_cast<unsigned>(pPos - mBlock));
+      while (mask == 0)
+      {
+        if (mEnd - mBlock <= static_cast<ptrdiff_t>(sBlockSize))
+        {
+          return mEnd;
+        }
+
+        LoadBlock(mBlock + sBlockSize);
+        mask = mMask;
+      }
+      return mBlock + std::countr_zero(mask);
+    }
+
+  private:
+    typedef uint64_t (* Classifier)(const char* pBlock, const char pQuoteChar, const char pSeparator);
+
+    static const size_t sBlockSize = 64;
+
+    void LoadBlock(const char* pBlock)
+    {
+      mBlock = pBlock;
+      const size_t length = static_cast<size_t>(mEnd - pBlock);
+      if (length >= sBlockSize)
+      {
+        mMask = mClassify(pBlock, mQuoteChar, mSeparator);
+      }
+      else
+      {
+        // copy the last partial block, so the kernels never read past the data
+        char padded[sBlockSize] = {};
+        std::memcpy(padded, pBlock, length);
+        mMask = mClassify(padded, mQuoteChar, mSeparator) & ((uint64_t(1) << length) - 1);
+      }
+    }
+
+    static uint64_t ClassifyScalar(const char* pBlock, const char pQuoteChar, const char pSeparator)
+    {
+      uint64_t mask = 0;
+      for (size_t i = 0; i < sBlockSize; ++i)
+      {
+        const char c = pBlock[i];
+        if ((c == pQuoteChar) || (c == pSeparator) || (c == '\r') || (c == '\n'))
+        {
+          mask |= uint64_t(1) << i;
+        }
+      }
+      return mask;
+    }
+
+#if defined(RAPIDCSV_HAS_SSE2)
+    static uint64_t ClassifySse2(const char* pBlock, const char pQuoteChar, const char pSeparator)
+    {
+      const __m128i quote = _mm_set1_epi8(pQuoteChar);
+      const __m128i separator = _mm_set1_epi8(pSeparator);
+      const __m128i cr = _mm_set1_epi8('\r');
+      const __m128i lf = _mm_set1_epi8('\n');
+      uint64_t mask = 0;
+      for (size_t i = 0; i < sBlockSize; i += 16)
+      {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBlock + i));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, separator)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(bytes, cr), _mm_cmpeq_epi8(bytes, lf)));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(hits))) << i;
+      }
+      return mask;
+    }
+#endif
+
+#if defined(RAPIDCSV_HAS_AVX2)
+#if !defined(_MSC_VER)
+    __attribute__((target("avx2")))
+#endif
+    static uint64_t ClassifyAvx2(const char* pBlock, const char pQuoteChar, const char pSeparator)
+    {
+      const __m256i quote = _mm256_set1_epi8(pQuoteChar);
+      const __m256i separator = _mm256_set1_epi8(pSeparator);
+      const __m256i cr = _mm256_set1_epi8('\r');
+      const __m256i lf = _mm256_set1_epi8('\n');
+      uint64_t mask = 0;
+      for (size_t i = 0; i < sBlockSize; i += 32)
+      {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBlock + i));
+        const __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote),
+                                                             _mm256_cmpeq_epi8(bytes, separator)),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(bytes, cr),
+                                                             _mm256_cmpeq_epi8(bytes, lf)));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hits))) << i;
+      }
+      return mask;
+    }
+#endif
+
+    // Picks the fastest kernel once, on first use.
+    static Classifier GetClassifier()
+    {
+      static const Classifier classifier = []() -> Classifier
+      {
+#if defined(RAPIDCSV_HAS_AVX2)
+#if defined(_MSC_VER)
+        return &ClassifyAvx2;  // only built when compiling for AVX2
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+          return &ClassifyAvx2;
+        }
+#endif
+#endif
+#if defined(RAPIDCSV_HAS_SSE2)
+        return &ClassifySse2;
+#else
+        return &ClassifyScalar;
+#endif
+      }();
+      return classifier;
+    }
+
+    const char* mBegin;
+    const char* mEnd;
+    char mQuoteChar;
+    char mSeparator;
+    Classifier mClassify;
+    const char* mBlock = nullptr;
+    uint64_t mMask = 0;
+  };
+
+  /**
+   * @brief     Class finishing raw cells as described by SeparatorParams: trimming spaces and
+   *            removing enclosing quotes by narrowing a view of the cell, and collapsing escaped
+   *            quotes only in the cells that have them.
+   */
+  class CellFinalizer
+  {
+  public:
+    /**
+     * @brief   Trim a raw cell and remove its enclosing quotes, without copying it.
+     * @param   pSeparatorParams      specifies the quote character and whether to trim and unquote.
+     * @param   pCell                 specifies the raw cell.
+     * @param   pQuoteCount           specifies the number of quote characters in the raw cell,
+     *                                as counted while scanning it.
+     * @param   pHasEscapes           receives whether the result may still contain escaped
+     *                                (doubled) quotes, which must then go through CollapseQuotes.
+     * @returns the part of pCell that is the value of the cell.
+     */
+    static std::string_view Narrow(const SeparatorParams& pSeparatorParams, std::string_view pCell,
+                                   const size_t pQuoteCount, bool& pHasEscapes)
+    {
+      if (pSeparatorParams.mTrim)
+      {
+        while (!pCell.empty() && isspace(static_cast<unsigned char>(pCell.front())))
+        {
+          pCell.remove_prefix(1);
+        }
+        while (!pCell.empty() && isspace(static_cast<unsigned char>(pCell.back())))
+        {
+          pCell.remove_suffix(1);
+        }
+      }
+
+      pHasEscapes = false;
+      if (pSeparatorParams.mAutoQuote && (pCell.size() >= 2) &&
+          (pCell.front() == pSeparatorParams.mQuoteChar) &&
+          (pCell.back() == pSeparatorParams.mQuoteChar))
+      {
+        // remove start/end quotes, anything beyond those two may be escaped quotes
+        pCell = pCell.substr(1, pCell.size() - 2);
+        pHasEscapes = pQuoteCount > 2;
+      }
+      return pCell;
+    }
+
+    /**
+     * @brief   Copy an unquoted cell, replacing each escaped (doubled) quote with a single one.
+     * @param   pQuoteChar            specifies the quote character.
+     * @param   pCell                 specifies the cell as returned by Narrow.
+     * @param   pOut                  specifies where to write the result, with room for at least
+     *                                pCell.size() characters.
+     * @returns the end of the result in pOut.
+     */
+    static char* CollapseQuotes(const char pQuoteChar, std::string_view pCell, char* pOut)
+    {
+      for (size_t i = 0; i < pCell.size(); ++i)
+      {
+        *pOut++ = pCell[i];
+        if ((pCell[i] == pQuoteChar) && (i + 1 < pCell.size()) && (pCell[i + 1] == pQuoteChar))
+        {
+          ++i;
+        }
+      }
+      return pOut;
+    }
+  };
+
+  /**
+   * @brief     Class reading CSV data one row at a time through a fixed-size buffer, for data
+   *            too large to hold in a Document. Rows are parsed exactly like Document parses
+   *            them, but labels are not interpreted, so a header row is returned like any other.
+   */
+  class RowReader
+  {
+  public:
+    /**
+     * @brief   Constructor
+     * @param   pPath                 specifies the path of an existing CSV-file to read.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     */
+    explicit RowReader(const std::string& pPath,
+                       const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                       const LineReaderParams& pLineReaderParams = LineReaderParams())
+      : mSeparatorParams(pSeparatorParams)
+      , mLineReaderParams(pLineReaderParams)
+      , mStream(&mFile)
+    {
+      mFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+      mFile.open(pPath, std::ios::binary);
+      mFile.seekg(0, std::ios::end);
+      mRemaining = mFile.tellg();
+      mFile.seekg(0, std::ios::beg);
+      mFile.exceptions(std::ifstream::badbit);
+
+      // check for UTF-8 Byte order mark and skip it when found
+      if (mRemaining >= 3)
+      {
+        char bom3b[3] = { '\0', '\0', '\0' };
+        mFile.read(bom3b, 3);
+        if ((bom3b[0] == '\xef') && (bom3b[1] == '\xbb') && (bom3b[2] == '\xbf'))
+        {
+          mRemaining -= 3;
+          mBufferStart = 3;
+        }
+        else
+        {
+          mFile.seekg(0, std::ios::beg);
+        }
+      }
+    }
+
+    /**
+     * @brief   Constructor
+     * @param   pStream               specifies a binary input stream to read CSV data from.
+     * @param   pLength               specifies the number of bytes to read from the stream.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     */
+    RowReader(std::istream& pStream, const std::streamsize pLength,
+              const SeparatorParams& pSeparatorParams = SeparatorParams(),
+              const LineReaderParams& pLineReaderParams = LineReaderParams())
+      : mSeparatorParams(pSeparatorParams)
+      , mLineReaderParams(pLineReaderParams)
+      , mStream(&pStream)
+      , mRemaining(pLength)
+    {
+    }
+
+    RowReader(const RowReader&) = delete;
+    RowReader& operator=(const RowReader&) = delete;
+
+    /**
+     * @brief   Read the next row. Strings already in pRow are reused, so reading all rows into
+     *          the same vector allocates only when a row has longer cells than before.
+     * @param   pRow                  receives the cells of the row.
+     * @returns false when there are no more rows, leaving pRow unchanged.
+     */
+    bool ReadRow(std::vector<std::string>& pRow)
+    {
+      size_t cellCount = 0;
+      auto endCell = [&]()
+      {
+        if (cellCount == pRow.size())
+        {
+          pRow.emplace_back();
+        }
+
+        // assign into the existing string, so that its storage is reused
+        std::string& out = pRow[cellCount];
+        bool hasEscapes = false;
+        const std::string_view cell = CellFinalizer::Narrow(mSeparatorParams, mCell, mCellQuotes, hasEscapes);
+        if (hasEscapes)
+        {
+          out.resize(cell.size());
+          out.resize(static_cast<size_t>(CellFinalizer::CollapseQuotes(mSeparatorParams.mQuoteChar, cell,
+                                                                       out.data()) - out.data()));
+        }
+        else
+        {
+          out.assign(cell);
+        }
+        ++cellCount;
+        mCell.clear();
+        mCellQuotes = 0;
+      };
+
+      while ((mPos < mLength) || Fill())
+      {
+        const char* data = mBuffer.data();
+        const char c = data[mPos];
+        if (c == mSeparatorParams.mQuoteChar)
+        {
+          if (mCell.empty() || (mCell[0] == mSeparatorParams.mQuoteChar))
+          {
+            mQuoted = !mQuoted;
+          }
+          mCell += c;
+          ++mCellQuotes;
+        }
+        else if (c == mSeparatorParams.mSeparator)
+        {
+          if (!mQuoted)
+          {
+            endCell();
+          }
+          else
+          {
+            mCell += c;
+          }
+        }
+        else if (c == '\r')
+        {
+          if (mSeparatorParams.mQuotedLinebreaks && mQuoted)
+          {
+            mCell += c;
+          }
+          else
+          {
+            ++mCR;
+          }
+        }
+        else if (c == '\n')
+        {
+          if (mSeparatorParams.mQuotedLinebreaks && mQuoted)
+          {
+            mCell += c;
+          }
+          else
+          {
+            ++mLF;
+            if (mLineReaderParams.mSkipEmptyLines && (cellCount == 0) && mCell.empty())
+            {
+              // skip empty line
+            }
+            else
+            {
+              endCell();
+              mQuoted = false;
+
+              if (mLineReaderParams.mSkipCommentLines && !pRow.at(0).empty() &&
+                  (pRow.at(0)[0] == mLineReaderParams.mCommentPrefix))
+              {
+                // skip comment line
+                cellCount = 0;
+              }
+              else
+              {
+                ++mPos;
+                pRow.resize(cellCount);
+                return true;
+              }
+            }
+          }
+        }
+        else
+        {
+          // append the whole run of ordinary characters at once
+          const size_t runEnd = static_cast<size_t>(mScanner.Next(data + mPos + 1) - data);
+          mCell.append(data + mPos, runEnd - mPos);
+          mPos = runEnd;
+          continue;
+        }
+        ++mPos;
+      }
+
+      // Handle last line without linebreak
+      if (!mCell.empty() || (cellCount > 0))
+      {
+        endCell();
+        pRow.resize(cellCount);
+        return true;
+      }
+      return false;
+    }
+
+    /**
+     * @brief   Read all remaining rows, passing each one to a callback.
+     * @param   pCallback             specifies a function called as pCallback(row) with the cells
+     *                                of each row, as a const std::vector<std::string>&. The
+     *                                vector is reused for the next row.
+     */
+    template<typename F>
+    void ForEachRow(F pCallback)
+    {
+      std::vector<std::string> row;
+      while (ReadRow(row))
+      {
+        pCallback(static_cast<const std::vector<std::string>&>(row));
+      }
+    }
+
+    /**
+     * @brief   Get whether the rows read so far end with CR/LF, i.e. whether at least half the
+     *          linebreaks had a carriage return.
+     * @returns true if the data uses CR/LF linebreaks.
+     */
+    bool HasCR() const
+    {
+      return mCR > (mLF / 2);
+    }
+
+    /**
+     * @brief   Get the byte offset of the data not read yet, i.e. just past the linebreak of the
+     *          last row read. Offsets count from the start of the file, byte order mark included,
+     *          or from where the stream was when the reader was constructed. The offsets before
+     *          and after ReadRow() give the bytes of the row as they are in the data.
+     * @returns offset of the next row.
+     */
+    size_t GetOffset() const
+    {
+      return static_cast<size_t>(mBufferStart) + mPos;
+    }
+
+  private:
+    static const size_t sBufferSize = 64 * 1024;
+
+    // Reads the next part of the data into the buffer. Returns false at the end of the data.
+    bool Fill()
+    {
+      if (mRemaining <= 0)
+      {
+        return false;
+      }
+
+      mBuffer.resize(sBufferSize);
+      const std::streamsize toReadLength = std::min<std::streamsize>(mRemaining, sBufferSize);
+      mStream->read(mBuffer.data(), toReadLength);
+
+      // With user-specified istream opened in non-binary mode on windows, we may have a
+      // data length mismatch, so ensure we don't parse outside actual data length read.
+      const std::streamsize readLength = mStream->gcount();
+      if (readLength <= 0)
+      {
+        mRemaining = 0;
+        return false;
+      }
+
+      mRemaining -= readLength;
+      mBufferStart += static_cast<std::streamsize>(mLength);
+      mPos = 0;
+      mLength = static_cast<size_t>(readLength);
+      mScanner = StructuralScanner(mBuffer.data(), mBuffer.data() + mLength,
+                                   mSeparatorParams.mQuoteChar, mSeparatorParams.mSeparator);
+      return true;
+    }
+
+    SeparatorParams mSeparatorParams;
+    LineReaderParams mLineReaderParams;
+    std::ifstream mFile;
+    std::istream* mStream;
+    std::streamsize mRemaining = 0;
+    std::streamsize mBufferStart = 0;
+    std::vector<char> mBuffer;
+    size_t mPos = 0;
+    size_t mLength = 0;
+    StructuralScanner mScanner = StructuralScanner(nullptr, nullptr, '\0', '\0');
+    std::string mCell;
+    size_t mCellQuotes = 0;
+    bool mQuoted = false;
+    int mCR = 0;
+    int mLF = 0;
+  };
+
+  /**
+   * @brief     Class writing CSV data one row at a time through a large buffer, quoting cells
+   *            with the separator or a space in them (when mAutoQuote is set), like Document
+   *            always has, or only the cells that would not read back the same otherwise
+   *            (see SetQuoteRule). Cells are checked for characters that need quoting
+   *            16 bytes at a time where SSE2 is available, and the buffer goes out in a single
+   *            write whenever it fills up. A file can either be replaced as a whole, through a
+   *            temporary file that is renamed over it when done, or have rows appended to it.
+   */
+  class RowWriter
+  {
+  public:
+    /**
+     * @brief   Which cells are enclosed in quotes.
+     */
+    enum class QuoteRule
+    {
+      /** cells with the separator or a space in them, as Document::Save writes them */
+      SeparatorOrSpace,
+      /** cells with the separator, a quote, CR or LF in them, and cells with spaces at
+       *  either end when reading trims them: only those that would otherwise read back different */
+      WhenNeeded
+    };
+
+    /**
+     * @brief   Constructor
+     * @param   pStream               specifies a binary output stream to write the data to.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pBufferSize           specifies how many bytes to collect before writing them.
+     */
+    explicit RowWriter(std::ostream& pStream,
+                       const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                       const size_t pBufferSize = sDefaultBufferSize)
+      : mSeparatorParams(pSeparatorParams)
+      , mBufferSize(pBufferSize)
+      , mStream(&pStream)
+    {
+      mBuffer.reserve(mBufferSize);
+    }
+
+    /**
+     * @brief   Constructor
+     * @param   pPath                 specifies the path of the CSV-file to write.
+     * @param   pAppend               specifies whether to add rows to the end of the file
+     *                                (default false). Otherwise the rows are written to a
+     *                                temporary file, which replaces the file only on Close(),
+     *                                so the file is never seen partly written.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pBufferSize           specifies how many bytes to collect before writing them.
+     */
+    explicit RowWriter(const std::string& pPath, const bool pAppend = false,
+                       const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                       const size_t pBufferSize = sDefaultBufferSize)
+      : mSeparatorParams(pSeparatorParams)
+      , mBufferSize(pBufferSize)
+      , mStream(&mFile)
+      , mPath(pPath)
+    {
+      if (pPath.empty())
+      {
+        throw std::ios_base::failure("no file path to write to");
+      }
+
+      mBuffer.reserve(mBufferSize);
+      mFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+      if (pAppend)
+      {
+        // a row added after an unterminated last line would be joined to it
+        std::ifstream existing(pPath, std::ios::binary | std::ios::ate);
+        if (existing.is_open() && (existing.tellg() > 0))
+        {
+          char last = '\0';
+          existing.seekg(-1, std::ios::end);
+          existing.get(last);
+          if (last != '\n')
+          {
+            mBuffer += GetLineEnding();
+          }
+        }
+        mFile.open(pPath, std::ios::binary | std::ios::app);
+      }
+      else
+      {
+        mTempPath = CreateTempFile(pPath);
+        try
+        {
+          mFile.open(mTempPath, std::ios::binary | std::ios::trunc);
+        }
+        catch (...)
+        {
+          std::error_code error;
+          std::filesystem::remove(mTempPath, error);
+          throw;
+        }
+      }
+    }
+
+    /**
+     * @brief   Destructor. Writes what is left in the buffer, except when replacing a file that
+     *          was not closed: then the temporary file is removed and the file is left as it was.
+     *          Errors are ignored, call Close() to get them.
+     */
+    ~RowWriter()
+    {
+      if (mClosed)
+      {
+        return;
+      }
+
+      try
+      {
+        if (!mTempPath.empty())
+        {
+          mFile.close();
+          std::error_code error;
+          std::filesystem::remove(mTempPath, error);
+        }
+        else
+        {
+          Flush();
+        }
+      }
+      catch (...)
+      {
+      }
+    }
+
+    RowWriter(const RowWriter&) = delete;
+    RowWriter& operator=(const RowWriter&) = delete;
+
+    /**
+     * @brief   Write a row.
+     * @param   pRow                  specifies the cells of the row, as a range of anything
+     *                                convertible to std::string_view.
+     */
+    template<typename R>
+    void WriteRow(const R& pRow)
+    {
+      bool first = true;
+      for (const auto& cell : pRow)
+      {
+        if (!first)
+        {
+          mBuffer += mSeparatorParams.mSeparator;
+        }
+        first = false;
+        WriteCell(std::string_view(cell));
+      }
+      mBuffer += GetLineEnding();
+
+      if (mBuffer.size() >= mBufferSize)
+      {
+        Flush();
+      }
+    }
+
+    /**
+     * @brief   Set which cells are enclosed in quotes from now on (default QuoteRule::SeparatorOrSpace).
+     * @param   pQuoteRule            specifies the rule.
+     */
+    void SetQuoteRule(const QuoteRule pQuoteRule)
+    {
+      mQuoteRule = pQuoteRule;
+    }
+
+    /**
+     * @brief   Write data as it is, without any quoting, e.g. rows copied from another file.
+     * @param   pData                 specifies the bytes to write, including any linebreaks.
+     */
+    void WriteRaw(std::string_view pData)
+    {
+      mBuffer += pData;
+      if (mBuffer.size() >= mBufferSize)
+      {
+        Flush();
+      }
+    }
+
+    /**
+     * @brief   Write the rows collected in the buffer to the stream or file.
+     */
+    void Flush()
+    {
+      if (!mBuffer.empty())
+      {
+        mStream->write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+        mBuffer.clear();
+      }
+    }
+
+    /**
+     * @brief   Write the rest of the rows and close the file, replacing the original file with
+     *          the new one unless appending. No rows can be written after this.
+     */
+    void Close()
+    {
+      Flush();
+      mClosed = true;
+      if (mFile.is_open())
+      {
+        mFile.close();
+        if (!mTempPath.empty())
+        {
+          ReplaceFile(mTempPath, mPath);
+        }
+      }
+    }
+
+    /**
+     * @brief   Create an empty temporary file to write the new contents of a file to. Every
+     *          call gets a file of its own, so writers replacing the same file at the same
+     *          time never write to each other's temporary files.
+     * @param   pPath                 specifies the path of the file to replace.
+     * @returns temporary file path, in the same directory so that it can be renamed over pPath.
+     */
+    static std::string CreateTempFile(const std::string& pPath)
+    {
+#if !defined(_WIN32)
+      std::string tempPath = pPath + ".XXXXXX";
+      const int fd = mkstemp(tempPath.data());
+      if (fd < 0)
+      {
+        throw std::ios_base::failure("unable to create temporary file for: " + pPath);
+      }
+      close(fd);
+      return tempPath;
+#else
+      std::random_device random;
+      for (int attempt = 0; attempt < 100; ++attempt)
+      {
+        const std::string tempPath = pPath + "." + std::to_string(random()) + ".tmp";
+        if (!std::filesystem::exists(tempPath))
+        {
+          std::ofstream file(tempPath, std::ios::binary);
+          if (file.is_open())
+          {
+            return tempPath;
+          }
+        }
+      }
+      throw std::ios_base::failure("unable to create temporary file for: " + pPath);
+#endif
+    }
+
+    /**
+     * @brief   Replace a file with a completely written temporary file in one rename, keeping
+     *          the permissions of the original file. The temporary file is synced to disk
+     *          before the rename and the directory after it, so that after a crash the file
+     *          has either its old or its new contents. The temporary file is removed on failure.
+     * @param   pTempPath             specifies the path of the new contents.
+     * @param   pPath                 specifies the path of the file to replace.
+     */
+    static void ReplaceFile(const std::string& pTempPath, const std::string& pPath)
+    {
+      std::error_code error;
+      const std::filesystem::file_status status = std::filesystem::status(pPath, error);
+      if (!error && std::filesystem::exists(status))
+      {
+        std::filesystem::permissions(pTempPath, status.permissions(), error);
+      }
+      else
+      {
+        SetNewFilePermissions(pTempPath);
+      }
+
+      if (!SyncFile(pTempPath, false))
+      {
+        std::filesystem::remove(pTempPath, error);
+        throw std::ios_base::failure("unable to sync file: " + pTempPath);
+      }
+
+      std::filesystem::rename(pTempPath, pPath, error);
+      if (error)
+      {
+        std::filesystem::remove(pTempPath, error);
+        throw std::ios_base::failure("unable to replace file: " + pPath);
+      }
+
+      const std::filesystem::path directory = std::filesystem::path(pPath).parent_path();
+      if (!SyncFile(directory.empty() ? std::string(".") : directory.string(), true))
+      {
+        throw std::ios_base::failure("unable to sync directory of file: " + pPath);
+      }
+    }
+
+  private:
+    const char* GetLineEnding() const
+    {
+      return mSeparatorParams.mHasCR ? "\r\n" : "\n";
+    }
+
+#if !defined(_WIN32)
+    // Flushes the file or directory at pPath to disk. Returns false on failure.
+    static bool SyncFile(const std::string& pPath, const bool pIsDirectory)
+    {
+      const int fd = open(pPath.c_str(), pIsDirectory ? (O_RDONLY | O_DIRECTORY) : O_RDONLY);
+      if (fd < 0)
+      {
+        return false;
+      }
+
+      const bool synced = (fsync(fd) == 0);
+      close(fd);
+      return synced;
+    }
+
+    // mkstemp creates files readable by the owner only, so a file that did not exist before
+    // gets the permissions any other new file would get, as allowed by the umask.
+    static void SetNewFilePermissions(const std::string& pPath)
+    {
+      const mode_t mask = umask(0);
+      umask(mask);
+      chmod(pPath.c_str(), static_cast<mode_t>(0666 & ~mask));
+    }
+#else
+    // Windows has no fsync for directories, and the temporary file was created as usual.
+    static bool SyncFile(const std::string&, const bool)
+    {
+      return true;
+    }
+
+    static void SetNewFilePermissions(const std::string&)
+    {
+    }
+#endif
+
+    void WriteCell(std::string_view pCell)
+    {
+      if (!mSeparatorParams.mAutoQuote || !NeedsQuotes(pCell))
+      {
+        mBuffer += pCell;
+        return;
+      }
+
+      // enclose in quotes, doubling the quotes inside
+      const char quote = mSeparatorParams.mQuoteChar;
+      mBuffer += quote;
+      for (size_t pos = pCell.find(quote); pos != std::string_view::npos; pos = pCell.find(quote))
+      {
+        mBuffer += pCell.substr(0, pos + 1);
+        mBuffer += quote;
+        pCell.remove_prefix(pos + 1);
+      }
+      mBuffer += pCell;
+      mBuffer += quote;
+    }
+
+    bool NeedsQuotes(std::string_view pCell) const
+    {
+      // With QuoteRule::WhenNeeded a cell with a quote in it is quoted too, as it could otherwise
+      // be read back as quoted, and so are cells with spaces at either end when reading trims
+      // them, as quotes keep them. Otherwise the rule looks for the separator and spaces only.
+      const bool whenNeeded = (mQuoteRule == QuoteRule::WhenNeeded);
+      if (whenNeeded && mSeparatorParams.mTrim && !pCell.empty() &&
+          (isspace(static_cast<unsigned char>(pCell.front())) || isspace(static_cast<unsigned char>(pCell.back()))))
+      {
+        return true;
+      }
+
+      // the characters that need quoting, repeated where the rule has fewer than four
+      const char separator = mSeparatorParams.mSeparator;
+      const char first = whenNeeded ? mSeparatorParams.mQuoteChar : ' ';
+      const char second = whenNeeded ? '\n' : separator;
+      const char third = whenNeeded ? '\r' : separator;
+      const char* pos = pCell.data();
+      const char* end = pos + pCell.size();
+#if defined(RAPIDCSV_HAS_SSE2)
+      const __m128i separators = _mm_set1_epi8(separator);
+      const __m128i firsts = _mm_set1_epi8(first);
+      const __m128i seconds = _mm_set1_epi8(second);
+      const __m128i thirds = _mm_set1_epi8(third);
+      for (; (end - pos) >= 16; pos += 16)
+      {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, separators), _mm_cmpeq_epi8(bytes, firsts)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(bytes, seconds), _mm_cmpeq_epi8(bytes, thirds)));
+        if (_mm_movemask_epi8(hits) != 0)
+        {
+          return true;
+        }
+      }
+#endif
+      for (; pos != end; ++pos)
+      {
+        if ((*pos == separator) || (*pos == first) || (*pos == second) || (*pos == third))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    static const size_t sDefaultBufferSize = 1024 * 1024;
+
+    SeparatorParams mSeparatorParams;
+    size_t mBufferSize = 0;
+    std::string mBuffer;
+    std::ofstream mFile;
+    std::ostream* mStream = nullptr;
+    std::string mPath;
+    std::string mTempPath;
+    QuoteRule mQuoteRule = QuoteRule::SeparatorOrSpace;
+    bool mClosed = false;
+  };
+
+  /**
+   * @brief     Class mapping row or column names to indexes with a flat open-addressing hash table.
+   *            The names are copied into one shared buffer and lookups take a std::string_view,
+   *            so looking up a name never builds a string.
+   */
+  class NameIndex
+  {
+  public:
+    /**
+     * @brief   Remove all names.
+     */
+    void Clear()
+    {
+      mSlots.clear();
+      mNames.clear();
+      mCount = 0;
+    }
+
+    /**
+     * @brief   Make room for a number of names, so that adding them does not grow the table.
+     * @param   pCount                specifies the number of names.
+     */
+    void Reserve(const size_t pCount)
+    {
+      const size_t capacity = GetCapacityFor(pCount);
+      if (capacity > mSlots.size())
+      {
+        Rehash(capacity);
+      }
+    }
+
+    /**
+     * @brief   Set the index of a name, adding the name if it is new.
+     * @param   pName                 specifies the name.
+     * @param   pIdx                  specifies the index.
+     */
+    void Assign(const std::string_view pName, const size_t pIdx)
+    {
+      if (GetCapacityFor(mCount + 1) > mSlots.size())
+      {
+        Rehash(std::max(GetCapacityFor(mCount + 1), mSlots.size() * 2));
+      }
+
+      const size_t hash = std::hash<std::string_view>()(pName);
+      Slot& slot = mSlots[Probe(pName, hash)];
+      if (slot.mIdx == sEmpty)
+      {
+        slot.mHash = hash;
+        slot.mNameOffset = mNames.size();
+        slot.mNameLength = pName.size();
+        mNames.append(pName);
+        ++mCount;
+      }
+      slot.mIdx = pIdx;
+    }
+
+    /**
+     * @brief   Look up a name.
+     * @param   pName                 specifies the name.
+     * @returns the index of the name, or -1 if the name is not in the table.
+     */
+    ssize_t Find(const std::string_view pName) const
+    {
+      if (mCount == 0)
+      {
+        return -1;
+      }
+
+      const Slot& slot = mSlots[Probe(pName, std::hash<std::string_view>()(pName))];
+      return (slot.mIdx == sEmpty) ? -1 : static_cast<ssize_t>(slot.mIdx);
+    }
+
+  private:
+    struct Slot
+    {
+      size_t mHash = 0;
+      size_t mNameOffset = 0;
+      size_t mNameLength = 0;
+      size_t mIdx = sEmpty;
+    };
+
+    static constexpr size_t sEmpty = std::numeric_limits<size_t>::max();
+
+    // The table is kept at most half full, so that probe sequences stay short.
+    static size_t GetCapacityFor(const size_t pCount)
+    {
+      return std::bit_ceil(std::max<size_t>(16, pCount * 2));
+    }
+
+    // Returns the position of the slot holding pName, or of the empty slot where it would go.
+    size_t Probe(const std::string_view pName, const size_t pHash) const
+    {
+      const size_t mask = mSlots.size() - 1;
+      for (size_t pos = pHash & mask; ; pos = (pos + 1) & mask)
+      {
+        const Slot& slot = mSlots[pos];
+        if ((slot.mIdx == sEmpty) ||
+            ((slot.mHash == pHash) &&
+             (std::string_view(mNames.data() + slot.mNameOffset, slot.mNameLength) == pName)))
+        {
+          return pos;
+        }
+      }
+    }
+
+    void Rehash(const size_t pCapacity)
+    {
+      std::vector<Slot> oldSlots(pCapacity);
+      oldSlots.swap(mSlots);
+      const size_t mask = pCapacity - 1;
+      for (const Slot& slot : oldSlots)
+      {
+        if (slot.mIdx != sEmpty)
+        {
+          size_t pos = slot.mHash & mask;
+          while (mSlots[pos].mIdx != sEmpty)
+          {
+            pos = (pos + 1) & mask;
+          }
+          mSlots[pos] = slot;
+        }
+      }
+    }
+
+    std::vector<Slot> mSlots;
+    std::string mNames;
+    size_t mCount = 0;
+  };
+
+  /**
+   * @brief     Class representing a CSV document.
+   */
+  class Document
+  {
+  public:
+    /**
+     * @brief   Constructor
+     * @param   pPath                 specifies the path of an existing CSV-file to populate the Document
+     *                                data with.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @param   pParallelParams       specifies how many threads to parse with.
+     */
+    explicit Document(const std::string& pPath = std::string(),
+                      const LabelParams& pLabelParams = LabelParams(),
+                      const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                      const ConverterParams& pConverterParams = ConverterParams(),
+                      const LineReaderParams& pLineReaderParams = LineReaderParams(),
+                      const ParallelParams& pParallelParams = ParallelParams())
+      : mPath(pPath)
+      , mLabelParams(pLabelParams)
+      , mSeparatorParams(pSeparatorParams)
+      , mConverterParams(pConverterParams)
+      , mLineReaderParams(pLineReaderParams)
+      , mParallelParams(pParallelParams)
+      , mData()
+      , mColumnNames()
+      , mRowNames()
+    {
+      if (!mPath.empty())
+      {
+        ReadCsv();
+      }
+    }
+
+    /**
+     * @brief   Constructor
+     * @param   pStream               specifies a binary input stream to read CSV data from.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @param   pParallelParams       specifies how many threads to parse with.
+     */
+    explicit Document(std::istream& pStream,
+                      const LabelParams& pLabelParams = LabelParams(),
+                      const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                      const ConverterParams& pConverterParams = ConverterParams(),
+                      const LineReaderParams& pLineReaderParams = LineReaderParams(),
+                      const ParallelParams& pParallelParams = ParallelParams())
+      : mPath()
+      , mLabelParams(pLabelParams)
+      , mSeparatorParams(pSeparatorParams)
+      , mConverterParams(pConverterParams)
+      , mLineReaderParams(pLineReaderParams)
+      , mParallelParams(pParallelParams)
+      , mData()
+      , mColumnNames()
+      , mRowNames()
+    {
+      ReadCsv(pStream);
+    }
+
+    /**
+     * @brief   Read Document data from file.
+     * @param   pPath                 specifies the path of an existing CSV-file to populate the Document
+     *                                data with.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @param   pParallelParams       specifies how many threads to parse with.
+     */
+    void Load(const std::string& pPath,
+              const LabelParams& pLabelParams = LabelParams(),
+              const SeparatorParams& pSeparatorParams = SeparatorParams(),
+              const ConverterParams& pConverterParams = ConverterParams(),
+              const LineReaderParams& pLineReaderParams = LineReaderParams(),
+              const ParallelParams& pParallelParams = ParallelParams())
+    {
+      mPath = pPath;
+      mLabelParams = pLabelParams;
+      mSeparatorParams = pSeparatorParams;
+      mConverterParams = pConverterParams;
+      mLineReaderParams = pLineReaderParams;
+      mParallelParams = pParallelParams;
+      ReadCsv();
+    }
+
+    /**
+     * @brief   Read Document data from stream.
+     * @param   pStream               specifies a binary input stream to read CSV data from.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @param   pParallelParams       specifies how many threads to parse with.
+     */
+    void Load(std::istream& pStream,
+              const LabelParams& pLabelParams = LabelParams(),
+              const SeparatorParams& pSeparatorParams = SeparatorParams(),
+              const ConverterParams& pConverterParams = ConverterParams(),
+              const LineReaderParams& pLineReaderParams = LineReaderParams(),
+              const ParallelParams& pParallelParams = ParallelParams())
+    {
+      mPath = "";
+      mLabelParams = pLabelParams;
+      mSeparatorParams = pSeparatorParams;
+      mConverterParams = pConverterParams;
+      mLineReaderParams = pLineReaderParams;
+      mParallelParams = pParallelParams;
+      ReadCsv(pStream);
+    }
+
+    /**
+     * @brief   Read Document data from a memory-mapped file. Cells are kept as views into
+     *          the mapping, only cells whose quotes must be unescaped are copied. The mapping
+     *          lives until the Document is modified, cleared or loaded again.
+     * @param   pPath                 specifies the path of an existing CSV-file to populate the Document
+     *                                data with.
+     * @param   pLabelParams          specifies which row and column should be treated as labels.
+     * @param   pSeparatorParams      specifies which field and row separators should be used.
+     * @param   pConverterParams      specifies how invalid numbers (including empty strings) should be
+     *                                handled.
+     * @param   pLineReaderParams     specifies how special line formats should be treated.
+     * @param   pParallelParams       specifies how many threads to parse with.
+     */
+    void LoadMapped(const std::string& pPath,
+                    const LabelParams& pLabelParams = LabelParams(),
+                    const SeparatorParams& pSeparatorParams = SeparatorParams(),
+                    const ConverterParams& pConverterParams = ConverterParams(),
+                    const LineReaderParams& pLineReaderParams = LineReaderParams(),
+                    const ParallelParams& pParallelParams = ParallelParams())
+    {
+      mPath = pPath;
+      mLabelParams = pLabelParams;
+      mSeparatorParams = pSeparatorParams;
+      mConverterParams = pConverterParams;
+      mLineReaderParams = pLineReaderParams;
+      mParallelParams = pParallelParams;
+      ReadCsvMapped();
+    }
+
+    /**
+     * @brief   Check whether Document data is held as views into a memory-mapped file.
+     * @returns true if loaded with LoadMapped() and not yet materialized.
+     */
+    bool IsMapped() const
+    {
+      return mMappedFile != nullptr;
+    }
+
+    /**
+     * @brief   Copy all cells of a memory-mapped Document into owned strings and release
+     *          the mapping. Called implicitly before any modification.
+     */
+    void Materialize()
+    {
+      if (!IsMapped())
+      {
+        return;
+      }
+
+      mData.clear();
+      mData.reserve(mViewData.size());
+      for (const auto& viewRow : mViewData)
+      {
+        mData.emplace_back(viewRow.begin(), viewRow.end());
+      }
+      mViewData.clear();
+      mArenas.clear();
+      mMappedFile.reset();
+    }
+
+    /**
+     * @brief   Write Document data to file. The data is written to a temporary file first, which
+     *          then replaces the file, so a memory-mapped Document can be saved over its own file.
+     * @param   pPath                 optionally specifies the path where the CSV-file will be created
+     *                                (if not specified, the original path provided when creating or
+     *                                loading the Document data will be used).
+     */
+    void Save(const std::string& pPath = std::string())
+    {
+      if (!pPath.empty())
+      {
+        mPath = pPath;
+      }
+      WriteCsv();
     }
 
     /**
@@ -582,8 +2028,11 @@ namespace rapidcsv
     void Clear()
     {
       mData.clear();
-      mColumnNames.clear();
-      mRowNames.clear();
+      mViewData.clear();
+      mArenas.clear();
+      mMappedFile.reset();
+      mColumnNames.Clear();
+      mRowNames.Clear();
 #ifdef HAS_CODECVT
       mIsUtf16 = false;
       mIsLE = false;
@@ -595,13 +2044,14 @@ namespace rapidcsv
      * @param   pColumnName           column label name.
      * @returns zero-based column index.
      */
-    ssize_t GetColumnIdx(const std::string& pColumnName) const
+    ssize_t GetColumnIdx(const std::string_view pColumnName) const
     {
       if (mLabelParams.mColumnNameIdx >= 0)
       {
-        if (mColumnNames.find(pColumnName) != mColumnNames.end())
+        const ssize_t dataColumnIdx = mColumnNames.Find(pColumnName);
+        if (dataColumnIdx >= 0)
         {
-          return static_cast<ssize_t>(mColumnNames.at(pColumnName)) - (mLabelParams.mRowNameIdx + 1);
+          return dataColumnIdx - (mLabelParams.mRowNameIdx + 1);
         }
       }
       return -1;
@@ -618,26 +2068,31 @@ namespace rapidcsv
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
       std::vector<T> column;
       Converter<T> converter(mConverterParams);
-      for (auto itRow = mData.begin(); itRow != mData.end(); ++itRow)
+      if constexpr (IsBuiltInConvertible<T>)
       {
-        if (std::distance(mData.begin(), itRow) > mLabelParams.mColumnNameIdx)
+        // convert the whole column in one loop straight from the cells, without making strings of them
+        if (IsMapped())
         {
-          if (dataColumnIdx < itRow->size())
-          {
-            T val;
-            converter.ToVal(itRow->at(dataColumnIdx), val);
-            column.push_back(val);
-          }
-          else
-          {
-            const std::string errStr = "requested column index " +
-              std::to_string(pColumnIdx) + " >= " +
-              std::to_string(itRow->size() - GetDataColumnIndex(0)) +
-              " (number of columns on row index " +
-              std::to_string(std::distance(mData.begin(), itRow) -
-                             (mLabelParams.mColumnNameIdx + 1)) + ")";
-            throw std::out_of_range(errStr);
-          }
+          ConvertColumn(mViewData, pColumnIdx, converter, column);
+        }
+        else
+        {
+          ConvertColumn(mData, pColumnIdx, converter, column);
+        }
+        return column;
+      }
+
+      for (size_t rowIdx = GetDataRowIndex(0); rowIdx < GetDataRowCount(); ++rowIdx)
+      {
+        if (dataColumnIdx < GetDataRowSize(rowIdx))
+        {
+          T val;
+          WithCell(rowIdx, dataColumnIdx, [&](const std::string& pCell) { converter.ToVal(pCell, val); });
+          column.push_back(val);
+        }
+        else
+        {
+          ThrowColumnOutOfRange(pColumnIdx, rowIdx);
         }
       }
       return column;
@@ -654,14 +2109,11 @@ namespace rapidcsv
     {
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
       std::vector<T> column;
-      for (auto itRow = mData.begin(); itRow != mData.end(); ++itRow)
+      for (size_t rowIdx = GetDataRowIndex(0); rowIdx < GetDataRowCount(); ++rowIdx)
       {
-        if (std::distance(mData.begin(), itRow) > mLabelParams.mColumnNameIdx)
-        {
-          T val;
-          pToVal(itRow->at(dataColumnIdx), val);
-          column.push_back(val);
-        }
+        T val;
+        WithCell(rowIdx, dataColumnIdx, [&](const std::string& pCell) { pToVal(pCell, val); });
+        column.push_back(val);
       }
       return column;
     }
@@ -699,6 +2151,70 @@ namespace rapidcsv
       return GetColumn<T>(static_cast<size_t>(columnIdx), pToVal);
     }
 
+    /**
+     * @brief   Get column by index as views into the Document data, without copying cells.
+     *          The views are invalidated when the Document is modified, cleared or destroyed.
+     * @param   pColumnIdx            zero-based column index.
+     * @returns vector of column data views.
+     */
+    std::vector<std::string_view> GetColumnView(const size_t pColumnIdx) const
+    {
+      const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
+      std::vector<std::string_view> column;
+      column.reserve(GetRowCount());
+      for (size_t rowIdx = GetDataRowIndex(0); rowIdx < GetDataRowCount(); ++rowIdx)
+      {
+        column.push_back(GetCellView(rowIdx, dataColumnIdx));
+      }
+      return column;
+    }
+
+    /**
+     * @brief   Get column by name as views into the Document data, without copying cells.
+     *          The views are invalidated when the Document is modified, cleared or destroyed.
+     * @param   pColumnName           column label name.
+     * @returns vector of column data views.
+     */
+    std::vector<std::string_view> GetColumnView(const std::string& pColumnName) const
+    {
+      const ssize_t columnIdx = GetColumnIdx(pColumnName);
+      if (columnIdx < 0)
+      {
+        throw std::out_of_range("column not found: " + pColumnName);
+      }
+      return GetColumnView(static_cast<size_t>(columnIdx));
+    }
+
+    /**
+     * @brief   Get several columns by name in a single pass over the rows. Each cell is passed
+     *          to the conversion function of its column as a view into the Document data, and
+     *          the result is written straight into the output buffer of the column.
+     * @param   pColumns              column projections, see MakeColumnProjection().
+     * @returns number of rows, i.e. number of values written to each buffer.
+     */
+    template<typename... Projections>
+    size_t GetColumns(const Projections&... pColumns) const
+    {
+      const std::array<size_t, sizeof...(Projections)> dataColumnIdxs = {
+        GetDataColumnIndex(GetExistingColumnIdx(pColumns.mColumnName))...
+      };
+
+      const size_t firstRowIdx = GetDataRowIndex(0);
+      for (size_t rowIdx = firstRowIdx; rowIdx < GetDataRowCount(); ++rowIdx)
+      {
+        size_t i = 0;
+        if (IsMapped())
+        {
+          (ProjectCell(mViewData[rowIdx], rowIdx, dataColumnIdxs[i++], pColumns), ...);
+        }
+        else
+        {
+          (ProjectCell(mData[rowIdx], rowIdx, dataColumnIdxs[i++], pColumns), ...);
+        }
+      }
+      return GetRowCount();
+    }
+
     /**
      * @brief   Set column by index.
      * @param   pColumnIdx            zero-based column index.
@@ -707,6 +2223,7 @@ namespace rapidcsv
     template<typename T>
     void SetColumn(const size_t pColumnIdx, const std::vector<T>& pColumn)
     {
+      Materialize();
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
 
       while (GetDataRowIndex(pColumn.size()) > GetDataRowCount())
@@ -756,6 +2273,7 @@ namespace rapidcsv
      */
     void RemoveColumn(const size_t pColumnIdx)
     {
+      Materialize();
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
       for (auto itRow = mData.begin(); itRow != mData.end(); ++itRow)
       {
@@ -790,6 +2308,7 @@ namespace rapidcsv
     void InsertColumn(const size_t pColumnIdx, const std::vector<T>& pColumn = std::vector<T>(),
                       const std::string& pColumnName = std::string())
     {
+      Materialize();
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
 
       std::vector<std::string> column;
@@ -840,7 +2359,7 @@ namespace rapidcsv
      */
     size_t GetColumnCount() const
     {
-      const ssize_t count = static_cast<ssize_t>((mData.size() > 0) ? mData.at(0).size() : 0) -
+      const ssize_t count = static_cast<ssize_t>(GetDataColumnCount()) -
         (mLabelParams.mRowNameIdx + 1);
       return (count >= 0) ? static_cast<size_t>(count) : 0;
     }
@@ -850,13 +2369,14 @@ namespace rapidcsv
      * @param   pRowName              row label name.
      * @returns zero-based row index.
      */
-    ssize_t GetRowIdx(const std::string& pRowName) const
+    ssize_t GetRowIdx(const std::string_view pRowName) const
     {
       if (mLabelParams.mRowNameIdx >= 0)
       {
-        if (mRowNames.find(pRowName) != mRowNames.end())
+        const ssize_t dataRowIdx = mRowNames.Find(pRowName);
+        if (dataRowIdx >= 0)
         {
-          return static_cast<ssize_t>(mRowNames.at(pRowName)) - (mLabelParams.mColumnNameIdx + 1);
+          return dataRowIdx - (mLabelParams.mColumnNameIdx + 1);
         }
       }
       return -1;
@@ -873,14 +2393,12 @@ namespace rapidcsv
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
       std::vector<T> row;
       Converter<T> converter(mConverterParams);
-      for (auto itCol = mData.at(dataRowIdx).begin(); itCol != mData.at(dataRowIdx).end(); ++itCol)
+      const size_t rowSize = GetDataRowSize(dataRowIdx);
+      for (size_t columnIdx = GetDataColumnIndex(0); columnIdx < rowSize; ++columnIdx)
       {
-        if (std::distance(mData.at(dataRowIdx).begin(), itCol) > mLabelParams.mRowNameIdx)
-        {
-          T val;
-          converter.ToVal(*itCol, val);
-          row.push_back(val);
-        }
+        T val;
+        ConvertCell(converter, dataRowIdx, columnIdx, val);
+        row.push_back(val);
       }
       return row;
     }
@@ -896,15 +2414,12 @@ namespace rapidcsv
     {
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
       std::vector<T> row;
-      Converter<T> converter(mConverterParams);
-      for (auto itCol = mData.at(dataRowIdx).begin(); itCol != mData.at(dataRowIdx).end(); ++itCol)
+      const size_t rowSize = GetDataRowSize(dataRowIdx);
+      for (size_t columnIdx = GetDataColumnIndex(0); columnIdx < rowSize; ++columnIdx)
       {
-        if (std::distance(mData.at(dataRowIdx).begin(), itCol) > mLabelParams.mRowNameIdx)
-        {
-          T val;
-          pToVal(*itCol, val);
-          row.push_back(val);
-        }
+        T val;
+        WithCell(dataRowIdx, columnIdx, [&](const std::string& pCell) { pToVal(pCell, val); });
+        row.push_back(val);
       }
       return row;
     }
@@ -950,6 +2465,7 @@ namespace rapidcsv
     template<typename T>
     void SetRow(const size_t pRowIdx, const std::vector<T>& pRow)
     {
+      Materialize();
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
 
       while ((dataRowIdx + 1) > GetDataRowCount())
@@ -999,6 +2515,7 @@ namespace rapidcsv
      */
     void RemoveRow(const size_t pRowIdx)
     {
+      Materialize();
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
       mData.erase(mData.begin() + static_cast<ssize_t>(dataRowIdx));
       UpdateRowNames();
@@ -1029,6 +2546,7 @@ namespace rapidcsv
     void InsertRow(const size_t pRowIdx, const std::vector<T>& pRow = std::vector<T>(),
                    const std::string& pRowName = std::string())
     {
+      Materialize();
       const size_t rowIdx = GetDataRowIndex(pRowIdx);
 
       std::vector<std::string> row;
@@ -1071,7 +2589,7 @@ namespace rapidcsv
      */
     size_t GetRowCount() const
     {
-      const ssize_t count = static_cast<ssize_t>(mData.size()) - (mLabelParams.mColumnNameIdx + 1);
+      const ssize_t count = static_cast<ssize_t>(GetDataRowCount()) - (mLabelParams.mColumnNameIdx + 1);
       return (count >= 0) ? static_cast<size_t>(count) : 0;
     }
 
@@ -1089,7 +2607,7 @@ namespace rapidcsv
 
       T val;
       Converter<T> converter(mConverterParams);
-      converter.ToVal(mData.at(dataRowIdx).at(dataColumnIdx), val);
+      ConvertCell(converter, dataRowIdx, dataColumnIdx, val);
       return val;
     }
 
@@ -1107,7 +2625,7 @@ namespace rapidcsv
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
 
       T val;
-      pToVal(mData.at(dataRowIdx).at(dataColumnIdx), val);
+      WithCell(dataRowIdx, dataColumnIdx, [&](const std::string& pCell) { pToVal(pCell, val); });
       return val;
     }
 
@@ -1243,6 +2761,7 @@ namespace rapidcsv
     template<typename T>
     void SetCell(const size_t pColumnIdx, const size_t pRowIdx, const T& pCell)
     {
+      Materialize();
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
 
@@ -1304,7 +2823,7 @@ namespace rapidcsv
         throw std::out_of_range("column name row index < 0: " + std::to_string(mLabelParams.mColumnNameIdx));
       }
 
-      return mData.at(static_cast<size_t>(mLabelParams.mColumnNameIdx)).at(dataColumnIdx);
+      return std::string(GetCellView(static_cast<size_t>(mLabelParams.mColumnNameIdx), dataColumnIdx));
     }
 
     /**
@@ -1314,13 +2833,14 @@ namespace rapidcsv
      */
     void SetColumnName(size_t pColumnIdx, const std::string& pColumnName)
     {
+      Materialize();
       if (mLabelParams.mColumnNameIdx < 0)
       {
         throw std::out_of_range("column name row index < 0: " + std::to_string(mLabelParams.mColumnNameIdx));
       }
 
       const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
-      mColumnNames[pColumnName] = dataColumnIdx;
+      mColumnNames.Assign(pColumnName, dataColumnIdx);
 
       // increase table size if necessary:
       const size_t rowIdx = static_cast<size_t>(mLabelParams.mColumnNameIdx);
@@ -1345,9 +2865,13 @@ namespace rapidcsv
     {
       if (mLabelParams.mColumnNameIdx >= 0)
       {
-        return std::vector<std::string>(mData.at(static_cast<size_t>(mLabelParams.mColumnNameIdx)).begin() +
-                                        (mLabelParams.mRowNameIdx + 1),
-                                        mData.at(static_cast<size_t>(mLabelParams.mColumnNameIdx)).end());
+        const size_t rowIdx = static_cast<size_t>(mLabelParams.mColumnNameIdx);
+        std::vector<std::string> columnNames;
+        for (size_t columnIdx = GetDataColumnIndex(0); columnIdx < GetDataRowSize(rowIdx); ++columnIdx)
+        {
+          columnNames.emplace_back(GetCellView(rowIdx, columnIdx));
+        }
+        return columnNames;
       }
 
       return std::vector<std::string>();
@@ -1366,7 +2890,7 @@ namespace rapidcsv
         throw std::out_of_range("row name column index < 0: " + std::to_string(mLabelParams.mRowNameIdx));
       }
 
-      return mData.at(dataRowIdx).at(static_cast<size_t>(mLabelParams.mRowNameIdx));
+      return std::string(GetCellView(dataRowIdx, static_cast<size_t>(mLabelParams.mRowNameIdx)));
     }
 
     /**
@@ -1376,8 +2900,9 @@ namespace rapidcsv
      */
     void SetRowName(size_t pRowIdx, const std::string& pRowName)
     {
+      Materialize();
       const size_t dataRowIdx = GetDataRowIndex(pRowIdx);
-      mRowNames[pRowName] = dataRowIdx;
+      mRowNames.Assign(pRowName, dataRowIdx);
       if (mLabelParams.mRowNameIdx < 0)
       {
         throw std::out_of_range("row name column index < 0: " + std::to_string(mLabelParams.mRowNameIdx));
@@ -1397,210 +2922,548 @@ namespace rapidcsv
       mData.at(dataRowIdx).at(static_cast<size_t>(mLabelParams.mRowNameIdx)) = pRowName;
     }
 
-    /**
-     * @brief   Get row names
-     * @returns vector of row names.
-     */
-    std::vector<std::string> GetRowNames() const
+    /**
+     * @brief   Get row names
+     * @returns vector of row names.
+     */
+    std::vector<std::string> GetRowNames() const
+    {
+      std::vector<std::string> rownames;
+      if (mLabelParams.mRowNameIdx >= 0)
+      {
+        for (size_t rowIdx = GetDataRowIndex(0); rowIdx < GetDataRowCount(); ++rowIdx)
+        {
+          rownames.emplace_back(GetCellView(rowIdx, static_cast<size_t>(mLabelParams.mRowNameIdx)));
+        }
+      }
+      return rownames;
+    }
+
+  private:
+    void ReadCsv()
+    {
+      std::ifstream stream;
+      stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+      stream.open(mPath, std::ios::binary);
+      ReadCsv(stream);
+    }
+
+    void ReadCsv(std::istream& pStream)
+    {
+      Clear();
+      pStream.seekg(0, std::ios::end);
+      std::streamsize length = pStream.tellg();
+      pStream.seekg(0, std::ios::beg);
+
+#ifdef HAS_CODECVT
+      std::vector<char> bom2b(2, '\0');
+      if (length >= 2)
+      {
+        pStream.read(bom2b.data(), 2);
+        pStream.seekg(0, std::ios::beg);
+      }
+
+      static const std::vector<char> bomU16le = { '\xff', '\xfe' };
+      static const std::vector<char> bomU16be = { '\xfe', '\xff' };
+      if ((bom2b == bomU16le) || (bom2b == bomU16be))
+      {
+        mIsUtf16 = true;
+        mIsLE = (bom2b == bomU16le);
+
+        std::wifstream wstream;
+        wstream.exceptions(std::wifstream::failbit | std::wifstream::badbit);
+        wstream.open(mPath, std::ios::binary);
+        if (mIsLE)
+        {
+          wstream.imbue(std::locale(wstream.getloc(),
+                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
+                                                           static_cast<std::codecvt_mode>(std::consume_header |
+                                                                                          std::little_endian)>));
+        }
+        else
+        {
+          wstream.imbue(std::locale(wstream.getloc(),
+                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
+                                                           std::consume_header>));
+        }
+        std::wstringstream wss;
+        wss << wstream.rdbuf();
+        std::string utf8 = ToString(wss.str());
+        std::stringstream ss(utf8);
+        ParseCsv(ss, static_cast<std::streamsize>(utf8.size()));
+      }
+      else
+#endif
+      {
+        // check for UTF-8 Byte order mark and skip it when found
+        if (length >= 3)
+        {
+          std::vector<char> bom3b(3, '\0');
+          pStream.read(bom3b.data(), 3);
+          static const std::vector<char> bomU8 = { '\xef', '\xbb', '\xbf' };
+          if (bom3b != bomU8)
+          {
+            // file does not start with a UTF-8 Byte order mark
+            pStream.seekg(0, std::ios::beg);
+          }
+          else
+          {
+            // file did start with a UTF-8 Byte order mark, simply skip it
+            length -= 3;
+          }
+        }
+
+        ParseCsv(pStream, length);
+      }
+    }
+
+    void ReadCsvMapped()
+    {
+      Clear();
+      mMappedFile = std::make_unique<MappedFile>(mPath);
+      const char* begin = mMappedFile->Data();
+      const char* end = begin + mMappedFile->Size();
+
+#ifdef HAS_CODECVT
+      if ((mMappedFile->Size() >= 2) &&
+          (((begin[0] == '\xff') && (begin[1] == '\xfe')) || ((begin[0] == '\xfe') && (begin[1] == '\xff'))))
+      {
+        // UTF-16 data has to be converted, so it cannot be used in place
+        mMappedFile.reset();
+        ReadCsv();
+        return;
+      }
+#endif
+
+      // check for UTF-8 Byte order mark and skip it when found
+      if ((mMappedFile->Size() >= 3) && (std::memcmp(begin, "\xef\xbb\xbf", 3) == 0))
+      {
+        begin += 3;
+      }
+
+      ParseMapped(begin, end);
+    }
+
+    void ParseMapped(const char* pBegin, const char* pEnd)
+    {
+      int cr = 0;
+      int lf = 0;
+      ParseViews(pBegin, pEnd, mViewData, mArenas, cr, lf);
+
+      // Assume CR/LF if at least half the linebreaks have CR
+      mSeparatorParams.mHasCR = (cr > (lf / 2));
+
+      // Set up column labels
+      UpdateColumnNames();
+
+      // Set up row labels
+      UpdateRowNames();
+    }
+
+    size_t GetParseThreadCount(const size_t pLength) const
+    {
+      size_t threadCount = mParallelParams.mThreadCount;
+      if (threadCount == 0)
+      {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+      }
+      const size_t minChunkSize = std::max<size_t>(1, mParallelParams.mMinChunkSize);
+      return std::max<size_t>(1, std::min(threadCount, pLength / minChunkSize));
+    }
+
+    // Runs pFunc(0) ... pFunc(pCount - 1), each on its own thread except the first.
+    template<typename F>
+    static void RunParallel(const size_t pCount, F pFunc)
+    {
+      std::vector<std::thread> threads;
+      threads.reserve(pCount);
+      for (size_t i = 1; i < pCount; ++i)
+      {
+        threads.emplace_back(pFunc, i);
+      }
+      pFunc(0);
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+    }
+
+    // Splits [pBegin, pEnd) into pieces for parallel parsing. Returns the piece boundaries,
+    // starting with pBegin and ending with pEnd, each one at the start of a record.
+    std::vector<const char*> FindRecordBoundaries(const char* pBegin, const char* pEnd) const
+    {
+      const size_t length = static_cast<size_t>(pEnd - pBegin);
+      const size_t threadCount = GetParseThreadCount(length);
+
+      // Candidate boundaries right after a linebreak near each even split point.
+      std::vector<const char*> candidates = { pBegin };
+      for (size_t i = 1; i < threadCount; ++i)
+      {
+        const char* from = std::max(pBegin + (length * i) / threadCount, candidates.back());
+        const void* lf = std::memchr(from, '\n', static_cast<size_t>(pEnd - from));
+        if ((lf == nullptr) || (static_cast<const char*>(lf) + 1 == pEnd))
+        {
+          break;
+        }
+        candidates.push_back(static_cast<const char*>(lf) + 1);
+      }
+      candidates.push_back(pEnd);
+
+      if (!mSeparatorParams.mQuotedLinebreaks || (candidates.size() <= 2))
+      {
+        // every linebreak ends a record
+        return candidates;
+      }
+
+      // A linebreak may be inside a quoted cell. After a linebreak the parser is either at the
+      // start of a record or inside a quoted cell, so scan every piece for both cases in
+      // parallel, then follow the actual state from the first piece to the last.
+      const size_t pieceCount = candidates.size() - 1;
+      std::vector<char> endsQuoted(pieceCount * 2);
+      RunParallel(pieceCount, [&](size_t pIdx)
+      {
+        endsQuoted[pIdx * 2] = EndsQuoted(candidates[pIdx], candidates[pIdx + 1], false);
+        endsQuoted[pIdx * 2 + 1] = EndsQuoted(candidates[pIdx], candidates[pIdx + 1], true);
+      });
+
+      std::vector<const char*> boundaries = { pBegin };
+      bool quoted = false;
+      for (size_t i = 0; i < pieceCount; ++i)
+      {
+        if ((i > 0) && !quoted)
+        {
+          boundaries.push_back(candidates[i]);
+        }
+        quoted = endsQuoted[i * 2 + (quoted ? 1 : 0)];
+      }
+      boundaries.push_back(pEnd);
+      return boundaries;
+    }
+
+    // Tracks only the quoting state of the parser over [pBegin, pEnd), which starts right after
+    // a linebreak, and returns whether it ends inside a quoted cell.
+    bool EndsQuoted(const char* pBegin, const char* pEnd, const bool pStartsQuoted) const
     {
-      std::vector<std::string> rownames;
-      if (mLabelParams.mRowNameIdx >= 0)
+      // when quoted, the cell is known to be non-empty and to start with a quote
+      bool quoted = pStartsQuoted;
+      bool cellEmpty = !pStartsQuoted;
+      bool frontQuote = pStartsQuoted;
+      StructuralScanner scanner(pBegin, pEnd, mSeparatorParams.mQuoteChar, mSeparatorParams.mSeparator);
+      for (const char* p = pBegin; p != pEnd; ++p)
       {
-        for (auto itRow = mData.begin(); itRow != mData.end(); ++itRow)
+        if (*p == mSeparatorParams.mQuoteChar)
+        {
+          if (cellEmpty || frontQuote)
+          {
+            quoted = !quoted;
+          }
+          frontQuote = cellEmpty || frontQuote;
+          cellEmpty = false;
+        }
+        else if ((*p == mSeparatorParams.mSeparator) && !quoted)
+        {
+          cellEmpty = true;
+          frontQuote = false;
+        }
+        else if ((*p == '\r') && !quoted)
+        {
+          // dropped, does not change the cell
+        }
+        else if ((*p == '\n') && !quoted)
         {
-          if (std::distance(mData.begin(), itRow) > mLabelParams.mColumnNameIdx)
+          cellEmpty = true;
+          frontQuote = false;
+        }
+        else
+        {
+          if (cellEmpty)
           {
-            rownames.push_back(itRow->at(static_cast<size_t>(mLabelParams.mRowNameIdx)));
+            cellEmpty = false;
+            frontQuote = false;
           }
+
+          // skip the rest of the run of ordinary characters
+          p = scanner.Next(p + 1) - 1;
         }
       }
-      return rownames;
+      return quoted;
     }
 
-  private:
-    void ReadCsv()
+    // Returns a new arena for the rows and copied cells of about pLength bytes of CSV data.
+    // Arenas are only used by one thread at a time, and take their blocks straight from
+    // the global heap rather than from whatever the default resource is.
+    static std::unique_ptr<std::pmr::monotonic_buffer_resource> MakeArena(const size_t pLength)
     {
-      std::ifstream stream;
-      stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-      stream.open(mPath, std::ios::binary);
-      ReadCsv(stream);
+      return std::make_unique<std::pmr::monotonic_buffer_resource>(std::max<size_t>(pLength, 64 * 1024),
+                                                                   std::pmr::new_delete_resource());
     }
 
-    void ReadCsv(std::istream& pStream)
+    // Parses [pBegin, pEnd) into rows of views, in parallel if so configured.
+    // The row vectors and the cells that had to be copied are allocated from arenas,
+    // which are added to pArenas and must outlive pRows.
+    void ParseViews(const char* pBegin, const char* pEnd,
+                    std::vector<std::pmr::vector<std::string_view>>& pRows,
+                    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>>& pArenas,
+                    int& pCR, int& pLF) const
     {
-      Clear();
-      pStream.seekg(0, std::ios::end);
-      std::streamsize length = pStream.tellg();
-      pStream.seekg(0, std::ios::beg);
-
-#ifdef HAS_CODECVT
-      std::vector<char> bom2b(2, '\0');
-      if (length >= 2)
+      const std::vector<const char*> boundaries = FindRecordBoundaries(pBegin, pEnd);
+      if (boundaries.size() <= 2)
       {
-        pStream.read(bom2b.data(), 2);
-        pStream.seekg(0, std::ios::beg);
+        pArenas.push_back(MakeArena(static_cast<size_t>(pEnd - pBegin)));
+        ParseSpan(pBegin, pEnd, pRows, *pArenas.back(), pCR, pLF);
+        return;
       }
 
-      static const std::vector<char> bomU16le = { '\xff', '\xfe' };
-      static const std::vector<char> bomU16be = { '\xfe', '\xff' };
-      if ((bom2b == bomU16le) || (bom2b == bomU16be))
+      struct Piece
       {
-        mIsUtf16 = true;
-        mIsLE = (bom2b == bomU16le);
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+        std::vector<std::pmr::vector<std::string_view>> rows;
+        int cr = 0;
+        int lf = 0;
+      };
+      std::vector<Piece> pieces(boundaries.size() - 1);
+      RunParallel(pieces.size(), [&](size_t pIdx)
+      {
+        Piece& piece = pieces[pIdx];
+        piece.arena = MakeArena(static_cast<size_t>(boundaries[pIdx + 1] - boundaries[pIdx]));
+        ParseSpan(boundaries[pIdx], boundaries[pIdx + 1], piece.rows, *piece.arena, piece.cr, piece.lf);
+      });
 
-        std::wifstream wstream;
-        wstream.exceptions(std::wifstream::failbit | std::wifstream::badbit);
-        wstream.open(mPath, std::ios::binary);
-        if (mIsLE)
-        {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
-                                                           static_cast<std::codecvt_mode>(std::consume_header |
-                                                                                          std::little_endian)>));
-        }
-        else
-        {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
-                                                           std::consume_header>));
-        }
-        std::wstringstream wss;
-        wss << wstream.rdbuf();
-        std::string utf8 = ToString(wss.str());
-        std::stringstream ss(utf8);
-        ParseCsv(ss, static_cast<std::streamsize>(utf8.size()));
+      size_t rowCount = pRows.size();
+      for (const auto& piece : pieces)
+      {
+        rowCount += piece.rows.size();
       }
-      else
-#endif
+      pRows.reserve(rowCount);
+      for (auto& piece : pieces)
       {
-        // check for UTF-8 Byte order mark and skip it when found
-        if (length >= 3)
-        {
-          std::vector<char> bom3b(3, '\0');
-          pStream.read(bom3b.data(), 3);
-          static const std::vector<char> bomU8 = { '\xef', '\xbb', '\xbf' };
-          if (bom3b != bomU8)
-          {
-            // file does not start with a UTF-8 Byte order mark
-            pStream.seekg(0, std::ios::beg);
-          }
-          else
-          {
-            // file did start with a UTF-8 Byte order mark, simply skip it
-            length -= 3;
-          }
-        }
-
-        ParseCsv(pStream, length);
+        // moving a row keeps its arena
+        std::move(piece.rows.begin(), piece.rows.end(), std::back_inserter(pRows));
+        pArenas.push_back(std::move(piece.arena));
+        pCR += piece.cr;
+        pLF += piece.lf;
       }
     }
 
-    void ParseCsv(std::istream& pStream, std::streamsize p_FileLength)
+    // Parses [pBegin, pEnd), which starts at the start of a record, into rows of views
+    // allocated from pArena.
+    void ParseSpan(const char* pBegin, const char* pEnd,
+                   std::vector<std::pmr::vector<std::string_view>>& pRows,
+                   std::pmr::memory_resource& pArena, int& pCR, int& pLF) const
     {
-      const std::streamsize bufLength = 64 * 1024;
-      std::vector<char> buffer(bufLength);
-      std::vector<std::string> row;
-      std::string cell;
+      std::vector<std::string_view> row;
+      std::vector<const char*> droppedCRs;
+      const char* cellBegin = pBegin;
+      size_t cellLength = 0;
+      size_t cellQuotes = 0;
+      char cellFront = '\0';
       bool quoted = false;
-      int cr = 0;
-      int lf = 0;
 
-      while (p_FileLength > 0)
+      auto endCell = [&](const char* pCellEnd)
       {
-        const std::streamsize toReadLength = std::min<std::streamsize>(p_FileLength, bufLength);
-        pStream.read(buffer.data(), toReadLength);
+        row.push_back(FinalizeCellView(cellBegin, pCellEnd, droppedCRs, cellQuotes, pArena));
+        droppedCRs.clear();
+        cellBegin = pCellEnd + 1;
+        cellLength = 0;
+        cellQuotes = 0;
+      };
 
-        // With user-specified istream opened in non-binary mode on windows, we may have a
-        // data length mismatch, so ensure we don't parse outside actual data length read.
-        const std::streamsize readLength = pStream.gcount();
-        if (readLength <= 0)
+      StructuralScanner scanner(pBegin, pEnd, mSeparatorParams.mQuoteChar, mSeparatorParams.mSeparator);
+      for (const char* p = pBegin; p != pEnd; ++p)
+      {
+        if (*p == mSeparatorParams.mQuoteChar)
         {
-          break;
+          if ((cellLength == 0) || (cellFront == mSeparatorParams.mQuoteChar))
+          {
+            quoted = !quoted;
+          }
+          cellFront = (cellLength == 0) ? *p : cellFront;
+          ++cellLength;
+          ++cellQuotes;
         }
-
-        for (size_t i = 0; i < static_cast<size_t>(readLength); ++i)
+        else if (*p == mSeparatorParams.mSeparator)
         {
-          if (buffer[i] == mSeparatorParams.mQuoteChar)
+          if (!quoted)
           {
-            if (cell.empty() || (cell[0] == mSeparatorParams.mQuoteChar))
-            {
-              quoted = !quoted;
-            }
-            cell += buffer[i];
+            endCell(p);
           }
-          else if (buffer[i] == mSeparatorParams.mSeparator)
+          else
           {
-            if (!quoted)
-            {
-              row.push_back(Unquote(Trim(cell)));
-              cell.clear();
-            }
-            else
-            {
-              cell += buffer[i];
-            }
+            cellFront = (cellLength == 0) ? *p : cellFront;
+            ++cellLength;
           }
-          else if (buffer[i] == '\r')
+        }
+        else if (*p == '\r')
+        {
+          if (mSeparatorParams.mQuotedLinebreaks && quoted)
           {
-            if (mSeparatorParams.mQuotedLinebreaks && quoted)
-            {
-              cell += buffer[i];
-            }
-            else
-            {
-              ++cr;
-            }
+            cellFront = (cellLength == 0) ? *p : cellFront;
+            ++cellLength;
           }
-          else if (buffer[i] == '\n')
+          else
+          {
+            ++pCR;
+            droppedCRs.push_back(p);
+          }
+        }
+        else if (*p == '\n')
+        {
+          if (mSeparatorParams.mQuotedLinebreaks && quoted)
+          {
+            cellFront = (cellLength == 0) ? *p : cellFront;
+            ++cellLength;
+          }
+          else
           {
-            if (mSeparatorParams.mQuotedLinebreaks && quoted)
+            ++pLF;
+            if (mLineReaderParams.mSkipEmptyLines && row.empty() && (cellLength == 0))
             {
-              cell += buffer[i];
+              // skip empty line
+              droppedCRs.clear();
+              cellBegin = p + 1;
             }
             else
             {
-              ++lf;
-              if (mLineReaderParams.mSkipEmptyLines && row.empty() && cell.empty())
+              endCell(p);
+
+              if (mLineReaderParams.mSkipCommentLines && !row.at(0).empty() &&
+                  (row.at(0)[0] == mLineReaderParams.mCommentPrefix))
               {
-                // skip empty line
+                // skip comment line
               }
               else
               {
-                row.push_back(Unquote(Trim(cell)));
-
-                if (mLineReaderParams.mSkipCommentLines && !row.at(0).empty() &&
-                    (row.at(0)[0] == mLineReaderParams.mCommentPrefix))
-                {
-                  // skip comment line
-                }
-                else
-                {
-                  mData.push_back(row);
-                }
-
-                cell.clear();
-                row.clear();
-                quoted = false;
+                pRows.emplace_back(row.begin(), row.end(), &pArena);
               }
+
+              row.clear();
+              quoted = false;
             }
           }
-          else
+        }
+        else
+        {
+          // take the whole run of ordinary characters at once
+          const char* runEnd = scanner.Next(p + 1);
+          cellFront = (cellLength == 0) ? *p : cellFront;
+          cellLength += static_cast<size_t>(runEnd - p);
+          p = runEnd - 1;
+        }
+      }
+
+      // Handle last line without linebreak
+      if ((cellLength != 0) || !row.empty())
+      {
+        endCell(pEnd);
+        pRows.emplace_back(row.begin(), row.end(), &pArena);
+        row.clear();
+      }
+    }
+
+    // Returns the trimmed and unquoted cell [pBegin, pEnd) as a view into the parsed data,
+    // copying it into pArena only if dropped carriage returns or escaped quotes have to be removed.
+    // pQuoteCount is the number of quote characters in the cell.
+    std::string_view FinalizeCellView(const char* pBegin, const char* pEnd,
+                                      const std::vector<const char*>& pDroppedCRs, const size_t pQuoteCount,
+                                      std::pmr::memory_resource& pArena) const
+    {
+      // carriage returns right before the end of the cell are simply cut off
+      size_t dropped = pDroppedCRs.size();
+      while ((dropped > 0) && (pDroppedCRs[dropped - 1] == pEnd - 1))
+      {
+        --dropped;
+        --pEnd;
+      }
+
+      std::string_view cell(pBegin, static_cast<size_t>(pEnd - pBegin));
+      std::string owned;
+      bool isOwned = false;
+      if (dropped > 0)
+      {
+        owned.reserve(cell.size());
+        size_t next = 0;
+        for (const char* p = pBegin; p != pEnd; ++p)
+        {
+          if ((next < dropped) && (pDroppedCRs[next] == p))
           {
-            cell += buffer[i];
+            ++next;
+            continue;
           }
+          owned.push_back(*p);
         }
-        p_FileLength -= readLength;
+        cell = owned;
+        isOwned = true;
       }
 
-      // Handle last line without linebreak
-      if (!cell.empty() || !row.empty())
+      bool hasEscapes = false;
+      cell = CellFinalizer::Narrow(mSeparatorParams, cell, pQuoteCount, hasEscapes);
+      if (hasEscapes && !cell.empty())
+      {
+        // collapse straight into the arena, the result is at most as long as the cell
+        char* copy = static_cast<char*>(pArena.allocate(cell.size(), 1));
+        const char* copyEnd = CellFinalizer::CollapseQuotes(mSeparatorParams.mQuoteChar, cell, copy);
+        return std::string_view(copy, static_cast<size_t>(copyEnd - copy));
+      }
+
+      if (isOwned && !cell.empty())
+      {
+        char* copy = static_cast<char*>(pArena.allocate(cell.size(), 1));
+        std::memcpy(copy, cell.data(), cell.size());
+        cell = std::string_view(copy, cell.size());
+      }
+      return cell;
+    }
+
+    void ParseCsv(std::istream& pStream, std::streamsize p_FileLength)
+    {
+      if ((p_FileLength > 0) && (GetParseThreadCount(static_cast<size_t>(p_FileLength)) > 1))
+      {
+        ParseCsvParallel(pStream, p_FileLength);
+        return;
+      }
+
+      RowReader reader(pStream, p_FileLength, mSeparatorParams, mLineReaderParams);
+      std::vector<std::string> row;
+      while (reader.ReadRow(row))
       {
-        row.push_back(Unquote(Trim(cell)));
-        cell.clear();
         mData.push_back(row);
-        row.clear();
       }
 
+      mSeparatorParams.mHasCR = reader.HasCR();
+
+      // Set up column labels
+      UpdateColumnNames();
+
+      // Set up row labels
+      UpdateRowNames();
+    }
+
+    // Reads the whole stream into memory, parses it into views in parallel and then
+    // copies the views into mData, again in parallel.
+    void ParseCsvParallel(std::istream& pStream, std::streamsize p_FileLength)
+    {
+      std::string buffer(static_cast<size_t>(p_FileLength), '\0');
+      pStream.read(&buffer[0], p_FileLength);
+      buffer.resize(static_cast<size_t>(std::max<std::streamsize>(0, pStream.gcount())));
+
+      std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> arenas;
+      std::vector<std::pmr::vector<std::string_view>> rows;
+      int cr = 0;
+      int lf = 0;
+      ParseViews(buffer.data(), buffer.data() + buffer.size(), rows, arenas, cr, lf);
+
+      mData.resize(rows.size());
+      const size_t threadCount = std::max<size_t>(1, std::min(GetParseThreadCount(buffer.size()), rows.size()));
+      RunParallel(threadCount, [&](size_t pIdx)
+      {
+        const size_t first = (rows.size() * pIdx) / threadCount;
+        const size_t last = (rows.size() * (pIdx + 1)) / threadCount;
+        for (size_t rowIdx = first; rowIdx < last; ++rowIdx)
+        {
+          mData[rowIdx].assign(rows[rowIdx].begin(), rows[rowIdx].end());
+        }
+      });
+
       // Assume CR/LF if at least half the linebreaks have CR
       mSeparatorParams.mHasCR = (cr > (lf / 2));
 
@@ -1621,154 +3484,223 @@ namespace rapidcsv
         std::string utf8 = ss.str();
         std::wstring wstr = ToWString(utf8);
 
-        std::wofstream wstream;
-        wstream.exceptions(std::wofstream::failbit | std::wofstream::badbit);
-        wstream.open(mPath, std::ios::binary | std::ios::trunc);
-
-        if (mIsLE)
+        const std::string tempPath = RowWriter::CreateTempFile(mPath);
+        try
         {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff,
-                                                           static_cast<std::codecvt_mode>(std::little_endian)>));
+          std::wofstream wstream;
+          wstream.exceptions(std::wofstream::failbit | std::wofstream::badbit);
+          wstream.open(tempPath, std::ios::binary | std::ios::trunc);
+
+          if (mIsLE)
+          {
+            wstream.imbue(std::locale(wstream.getloc(),
+                                      new std::codecvt_utf16<wchar_t, 0x10ffff,
+                                                             static_cast<std::codecvt_mode>(std::little_endian)>));
+          }
+          else
+          {
+            wstream.imbue(std::locale(wstream.getloc(),
+                                      new std::codecvt_utf16<wchar_t, 0x10ffff>));
+          }
+
+          wstream << static_cast<wchar_t>(0xfeff);
+          wstream << wstr;
+          wstream.close();
         }
-        else
+        catch (...)
         {
-          wstream.imbue(std::locale(wstream.getloc(),
-                                    new std::codecvt_utf16<wchar_t, 0x10ffff>));
+          std::error_code error;
+          std::filesystem::remove(tempPath, error);
+          throw;
         }
-
-        wstream << static_cast<wchar_t>(0xfeff);
-        wstream << wstr;
+        RowWriter::ReplaceFile(tempPath, mPath);
       }
       else
 #endif
       {
-        std::ofstream stream;
-        stream.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-        stream.open(mPath, std::ios::binary | std::ios::trunc);
-        WriteCsv(stream);
+        RowWriter writer(mPath, false, mSeparatorParams);
+        WriteRows(writer);
+        writer.Close();
       }
     }
 
     void WriteCsv(std::ostream& pStream) const
     {
-      for (auto itr = mData.begin(); itr != mData.end(); ++itr)
+      RowWriter writer(pStream, mSeparatorParams);
+      WriteRows(writer);
+      writer.Close();
+    }
+
+    void WriteRows(RowWriter& pWriter) const
+    {
+      if (IsMapped())
       {
-        for (auto itc = itr->begin(); itc != itr->end(); ++itc)
+        for (const auto& row : mViewData)
         {
-          if (mSeparatorParams.mAutoQuote &&
-              ((itc->find(mSeparatorParams.mSeparator) != std::string::npos) ||
-               (itc->find(' ') != std::string::npos)))
-          {
-            // escape quotes in string
-            std::string str = *itc;
-            const std::string quoteCharStr = std::string(1, mSeparatorParams.mQuoteChar);
-            ReplaceString(str, quoteCharStr, quoteCharStr + quoteCharStr);
-
-            pStream << quoteCharStr << str << quoteCharStr;
-          }
-          else
-          {
-            pStream << *itc;
-          }
-
-          if (std::distance(itc, itr->end()) > 1)
-          {
-            pStream << mSeparatorParams.mSeparator;
-          }
+          pWriter.WriteRow(row);
+        }
+      }
+      else
+      {
+        for (const auto& row : mData)
+        {
+          pWriter.WriteRow(row);
         }
-        pStream << (mSeparatorParams.mHasCR ? "\r\n" : "\n");
       }
     }
 
     size_t GetDataRowCount() const
     {
-      return mData.size();
+      return IsMapped() ? mViewData.size() : mData.size();
     }
 
     size_t GetDataColumnCount() const
     {
-      return (mData.size() > 0) ? mData.at(0).size() : 0;
+      return (GetDataRowCount() > 0) ? GetDataRowSize(0) : 0;
     }
 
-    inline size_t GetDataRowIndex(const size_t pRowIdx) const
+    size_t GetDataRowSize(const size_t pDataRowIdx) const
     {
-      return pRowIdx + static_cast<size_t>(mLabelParams.mColumnNameIdx + 1);
+      return IsMapped() ? mViewData.at(pDataRowIdx).size() : mData.at(pDataRowIdx).size();
     }
 
-    inline size_t GetDataColumnIndex(const size_t pColumnIdx) const
+    std::string_view GetCellView(const size_t pDataRowIdx, const size_t pDataColumnIdx) const
     {
-      return pColumnIdx + static_cast<size_t>(mLabelParams.mRowNameIdx + 1);
+      if (IsMapped())
+      {
+        return mViewData.at(pDataRowIdx).at(pDataColumnIdx);
+      }
+      return mData.at(pDataRowIdx).at(pDataColumnIdx);
     }
 
-    std::string Trim(const std::string& pStr) const
+    // Calls pFunc with the cell as a std::string, which only has to be created for mapped data.
+    template<typename F>
+    void WithCell(const size_t pDataRowIdx, const size_t pDataColumnIdx, F pFunc) const
     {
-      if (mSeparatorParams.mTrim)
+      if (IsMapped())
       {
-        std::string str = pStr;
-
-        // ltrim
-        str.erase(str.begin(), std::find_if(str.begin(), str.end(), [](int ch) { return !isspace(ch); }));
-
-        // rtrim
-        str.erase(std::find_if(str.rbegin(), str.rend(), [](int ch) { return !isspace(ch); }).base(), str.end());
+        const std::string cell(mViewData.at(pDataRowIdx).at(pDataColumnIdx));
+        pFunc(cell);
+      }
+      else
+      {
+        pFunc(mData.at(pDataRowIdx).at(pDataColumnIdx));
+      }
+    }
 
-        return str;
+    // Converts a cell with pConverter. The types Converter handles itself are converted straight
+    // from the parsed data, others get the cell as a std::string like custom converters expect.
+    template<typename T>
+    void ConvertCell(const Converter<T>& pConverter, const size_t pDataRowIdx, const size_t pDataColumnIdx,
+                     T& pVal) const
+    {
+      if constexpr (IsBuiltInConvertible<T>)
+      {
+        pConverter.ViewToVal(GetCellView(pDataRowIdx, pDataColumnIdx), pVal);
       }
       else
       {
-        return pStr;
+        WithCell(pDataRowIdx, pDataColumnIdx, [&](const std::string& pCell) { pConverter.ToVal(pCell, pVal); });
       }
     }
 
-    std::string Unquote(const std::string& pStr) const
+    // Converts column pColumnIdx of pRows, which are either mViewData or mData, into pColumn.
+    template<typename T, typename R>
+    void ConvertColumn(const std::vector<R>& pRows, const size_t pColumnIdx, const Converter<T>& pConverter,
+                       std::vector<T>& pColumn) const
     {
-      if (mSeparatorParams.mAutoQuote && (pStr.size() >= 2) &&
-          (pStr.front() == mSeparatorParams.mQuoteChar) &&
-          (pStr.back() == mSeparatorParams.mQuoteChar))
+      const size_t dataColumnIdx = GetDataColumnIndex(pColumnIdx);
+      const size_t firstRowIdx = GetDataRowIndex(0);
+      pColumn.reserve((pRows.size() > firstRowIdx) ? (pRows.size() - firstRowIdx) : 0);
+      for (size_t rowIdx = firstRowIdx; rowIdx < pRows.size(); ++rowIdx)
       {
-        // remove start/end quotes
-        std::string str = pStr.substr(1, pStr.size() - 2);
+        const R& row = pRows[rowIdx];
+        if (dataColumnIdx >= row.size())
+        {
+          ThrowColumnOutOfRange(pColumnIdx, rowIdx);
+        }
+        pConverter.ViewToVal(std::string_view(row[dataColumnIdx]), pColumn.emplace_back());
+      }
+    }
 
-        // unescape quotes in string
-        const std::string quoteCharStr = std::string(1, mSeparatorParams.mQuoteChar);
-        ReplaceString(str, quoteCharStr + quoteCharStr, quoteCharStr);
+    [[noreturn]] void ThrowColumnOutOfRange(const size_t pColumnIdx, const size_t pDataRowIdx) const
+    {
+      const std::string errStr = "requested column index " +
+        std::to_string(pColumnIdx) + " >= " +
+        std::to_string(GetDataRowSize(pDataRowIdx) - GetDataColumnIndex(0)) +
+        " (number of columns on row index " +
+        std::to_string(pDataRowIdx - GetDataRowIndex(0)) + ")";
+      throw std::out_of_range(errStr);
+    }
 
-        return str;
+    size_t GetExistingColumnIdx(const std::string& pColumnName) const
+    {
+      const ssize_t columnIdx = GetColumnIdx(pColumnName);
+      if (columnIdx < 0)
+      {
+        throw std::out_of_range("column not found: " + pColumnName);
       }
-      else
+      return static_cast<size_t>(columnIdx);
+    }
+
+    // Converts one cell of pRow for GetColumns().
+    template<typename R, typename P>
+    void ProjectCell(const R& pRow, const size_t pDataRowIdx, const size_t pDataColumnIdx, const P& pColumn) const
+    {
+      const size_t rowIdx = pDataRowIdx - GetDataRowIndex(0);
+      if (pDataColumnIdx >= pRow.size())
       {
-        return pStr;
+        const std::string errStr = "requested column index " +
+          std::to_string(pDataColumnIdx - GetDataColumnIndex(0)) + " >= " +
+          std::to_string(pRow.size() - GetDataColumnIndex(0)) +
+          " (number of columns on row index " + std::to_string(rowIdx) + ")";
+        throw std::out_of_range(errStr);
       }
+      pColumn.mToVal(std::string_view(pRow[pDataColumnIdx]), pColumn.mOut[rowIdx]);
+    }
+
+    inline size_t GetDataRowIndex(const size_t pRowIdx) const
+    {
+      return pRowIdx + static_cast<size_t>(mLabelParams.mColumnNameIdx + 1);
+    }
+
+    inline size_t GetDataColumnIndex(const size_t pColumnIdx) const
+    {
+      return pColumnIdx + static_cast<size_t>(mLabelParams.mRowNameIdx + 1);
     }
 
+    // The name indexes are rebuilt right away whenever the labels may have changed,
+    // so that lookups never modify the Document and const Documents can be shared
+    // between threads.
     void UpdateColumnNames()
     {
-      mColumnNames.clear();
+      mColumnNames.Clear();
       if ((mLabelParams.mColumnNameIdx >= 0) &&
-          (static_cast<ssize_t>(mData.size()) > mLabelParams.mColumnNameIdx))
+          (static_cast<ssize_t>(GetDataRowCount()) > mLabelParams.mColumnNameIdx))
       {
-        size_t i = 0;
-        for (auto& columnName : mData[static_cast<size_t>(mLabelParams.mColumnNameIdx)])
+        const size_t rowIdx = static_cast<size_t>(mLabelParams.mColumnNameIdx);
+        mColumnNames.Reserve(GetDataRowSize(rowIdx));
+        for (size_t i = 0; i < GetDataRowSize(rowIdx); ++i)
         {
-          mColumnNames[columnName] = i++;
+          mColumnNames.Assign(GetCellView(rowIdx, i), i);
         }
       }
     }
 
     void UpdateRowNames()
     {
-      mRowNames.clear();
+      mRowNames.Clear();
       if ((mLabelParams.mRowNameIdx >= 0) &&
-          (static_cast<ssize_t>(mData.size()) >
+          (static_cast<ssize_t>(GetDataRowCount()) >
            (mLabelParams.mColumnNameIdx + 1)))
       {
+        mRowNames.Reserve(GetDataRowCount());
         size_t i = 0;
-        for (auto& dataRow : mData)
+        for (size_t rowIdx = 0; rowIdx < GetDataRowCount(); ++rowIdx)
         {
-          if (static_cast<ssize_t>(dataRow.size()) > mLabelParams.mRowNameIdx)
+          if (static_cast<ssize_t>(GetDataRowSize(rowIdx)) > mLabelParams.mRowNameIdx)
           {
-            mRowNames[dataRow[static_cast<size_t>(mLabelParams.mRowNameIdx)]] = i++;
+            mRowNames.Assign(GetCellView(rowIdx, static_cast<size_t>(mLabelParams.mRowNameIdx)), i++);
           }
         }
       }
@@ -1793,26 +3725,19 @@ namespace rapidcsv
 #endif
 #endif
 
-    static void ReplaceString(std::string& pStr, const std::string& pSearch, const std::string& pReplace)
-    {
-      size_t pos = 0;
-
-      while ((pos = pStr.find(pSearch, pos)) != std::string::npos)
-      {
-        pStr.replace(pos, pSearch.size(), pReplace);
-        pos += pReplace.size();
-      }
-    }
-
   private:
     std::string mPath;
     LabelParams mLabelParams;
     SeparatorParams mSeparatorParams;
     ConverterParams mConverterParams;
     LineReaderParams mLineReaderParams;
+    ParallelParams mParallelParams;
     std::vector<std::vector<std::string>> mData;
-    std::map<std::string, size_t> mColumnNames;
-    std::map<std::string, size_t> mRowNames;
+    std::unique_ptr<MappedFile> mMappedFile;
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> mArenas;
+    std::vector<std::pmr::vector<std::string_view>> mViewData;
+    NameIndex mColumnNames;
+    NameIndex mRowNames;
 #ifdef HAS_CODECVT
     bool mIsUtf16 = false;
     bool mIsLE = false;
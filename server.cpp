@@ -0,0 +1,376 @@
+#include "server.h"
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <csignal>
+#include <iterator>  // for std::size
+#include <unordered_map>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#endif
+
+namespace {
+
+// Queries are a few short arguments, so anything longer than this is not a client of ours.
+constexpr std::size_t maxQuerySize{64 * 1024};
+
+#if !defined(_WIN32)
+// Fills in the address of the socket at `path`. Returns `false` if the path is too long for it.
+bool makeAddress(const std::filesystem::path& path, sockaddr_un& address) {
+    const auto& name = path.native();
+    if (name.size() >= sizeof address.sun_path) {
+        return false;
+    }
+    std::memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+    return true;
+}
+
+// Writes all of `data` to the socket `fd`. Returns `false` if the other end went away.
+bool sendAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+#endif
+
+#if defined(__linux__)
+// Reads a length or count of the query protocol at `offset` of `data` into `value`
+// and moves `offset` past it. Returns `false` if it has not arrived yet.
+bool readQueryNumber(const std::string& data, std::size_t& offset, std::uint32_t& value) {
+    if (data.size() - offset < sizeof value) {
+        return false;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof value);
+    offset += sizeof value;
+    return true;
+}
+
+// Returns the arguments of the query in `data` if all of it has arrived.
+std::optional<std::vector<std::string>> parseQuery(const std::string& data) {
+    std::size_t offset{0};
+    std::uint32_t count{0};
+    if (!readQueryNumber(data, offset, count)) {
+        return std::nullopt;
+    }
+    std::vector<std::string> args;
+    for (std::uint32_t i{0}; i < count; i++) {
+        std::uint32_t length{0};
+        if (!readQueryNumber(data, offset, length) || data.size() - offset < length) {
+            return std::nullopt;  // the rest is still coming
+        }
+        args.emplace_back(data, offset, length);
+        offset += length;
+    }
+    return args;
+}
+
+// One client connection: the query read so far, then the reply being written.
+struct Connection {
+    std::string query;
+    std::string reply;
+    std::size_t sent{0};
+    bool replying{false};
+};
+
+// The descriptors and the socket file of a running server. They are released by the
+// destructor, so that the socket file is removed however the server stops.
+struct Server {
+    explicit Server(const sigset_t& blockedSignals) : blockedSignals(blockedSignals) { }
+
+    ~Server() {
+        for (const auto& [fd, connection] : connections) {
+            ::close(fd);
+        }
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            ::unlink(socketPath.c_str());
+        }
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+        if (signalFd >= 0) {
+            ::close(signalFd);
+        }
+        ::sigprocmask(SIG_UNBLOCK, &blockedSignals, nullptr);
+    }
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    sigset_t blockedSignals;
+    int signalFd{-1};
+    int epollFd{-1};
+    int listenFd{-1};
+    std::filesystem::path socketPath;  // only removed once `listenFd` is bound to it
+    std::unordered_map<int, Connection> connections;
+};
+
+// Binds a listening socket to `path`, replacing the socket file of a server
+// that is no longer running. Returns -1 and prints a message on failure.
+int listenAt(const std::filesystem::path& path) {
+    sockaddr_un address;
+    if (!makeAddress(path, address)) {
+        std::cerr << "socket path is too long: " << path.string() << '\n';
+        return -1;
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "unable to create a socket: " << std::strerror(errno) << '\n';
+        return -1;
+    }
+
+    auto bindSocket = [&]() { return ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) == 0; };
+    bool bound = bindSocket();
+    if (!bound && errno == EADDRINUSE) {
+        // Only take the path over if nobody answers there anymore.
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const bool alive = probe >= 0
+            && ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof address) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (alive) {
+            std::cerr << "a server is already listening on " << path.string() << '\n';
+            ::close(fd);
+            return -1;
+        }
+        ::unlink(path.c_str());
+        bound = bindSocket();
+    }
+    if (!bound || ::listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "unable to listen on " << path.string() << ": " << std::strerror(errno) << '\n';
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+#endif
+
+}  // namespace
+
+bool serveQueries(const std::filesystem::path& socketPath, const QueryHandler& answer) {
+#if defined(__linux__)
+    // SIGINT and SIGTERM arrive as events in the loop, so the socket file can be removed on the way out.
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    if (::sigprocmask(SIG_BLOCK, &stopSignals, nullptr) != 0) {
+        std::cerr << "unable to block signals: " << std::strerror(errno) << '\n';
+        return false;
+    }
+    Server server{stopSignals};
+    server.signalFd = ::signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+    server.epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (server.signalFd < 0 || server.epollFd < 0) {
+        std::cerr << "unable to set up the event loop: " << std::strerror(errno) << '\n';
+        return false;
+    }
+    server.listenFd = listenAt(socketPath);
+    if (server.listenFd < 0) {
+        return false;
+    }
+    server.socketPath = socketPath;
+    const int signalFd = server.signalFd;
+    const int epollFd = server.epollFd;
+    const int listenFd = server.listenFd;
+    auto& connections = server.connections;
+
+    auto watch = [epollFd](int fd, std::uint32_t events, int operation) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        return ::epoll_ctl(epollFd, operation, fd, &event) == 0;
+    };
+    watch(listenFd, EPOLLIN, EPOLL_CTL_ADD);
+    watch(signalFd, EPOLLIN, EPOLL_CTL_ADD);
+
+    auto hangUp = [&](int fd) {
+        ::close(fd);  // this also takes it out of the epoll set
+        connections.erase(fd);
+    };
+
+    // Sends as much of the reply as the socket takes. Returns `true` when all of it is sent.
+    auto sendReply = [](int fd, Connection& connection) {
+        while (connection.sent < connection.reply.size()) {
+            const auto written = ::send(fd, connection.reply.data() + connection.sent,
+                                        connection.reply.size() - connection.sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return false;
+            }
+            if (written <= 0) {
+                return true;  // the client went away, so there is nothing more to do
+            }
+            connection.sent += static_cast<std::size_t>(written);
+        }
+        return true;
+    };
+
+    bool running{true};
+    epoll_event ready[64];
+    while (running) {
+        const int count = ::epoll_wait(epollFd, ready, static_cast<int>(std::size(ready)), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "event loop failed: " << std::strerror(errno) << '\n';
+            return false;
+        }
+
+        for (int i{0}; i < count; i++) {
+            const int fd = ready[i].data.fd;
+            if (fd == signalFd) {
+                running = false;
+            }
+            else if (fd == listenFd) {
+                int client{-1};
+                while ((client = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    if (watch(client, EPOLLIN, EPOLL_CTL_ADD)) {
+                        connections.emplace(client, Connection{});
+                    }
+                    else {
+                        ::close(client);
+                    }
+                }
+            }
+            else if (auto found = connections.find(fd); found != connections.end()) {
+                auto& connection = found->second;
+                if (connection.replying) {
+                    if (sendReply(fd, connection)) {
+                        hangUp(fd);
+                    }
+                    continue;
+                }
+
+                char buffer[4096];
+                bool closed{false};
+                while (true) {
+                    const auto length = ::read(fd, buffer, sizeof buffer);
+                    if (length > 0) {
+                        connection.query.append(buffer, static_cast<std::size_t>(length));
+                        continue;
+                    }
+                    if (length < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    closed = length == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                    break;
+                }
+
+                const auto args = parseQuery(connection.query);
+                if (!args.has_value()) {
+                    if (closed || connection.query.size() > maxQuerySize) {
+                        hangUp(fd);  // gave up before the query was complete, or is not a client of ours
+                    }
+                    continue;
+                }
+
+                QueryReply reply;
+                try {
+                    reply = answer(args.value());
+                }
+                catch (const std::exception& e) {
+                    reply = {false, std::string{"unable to answer the query: "} + e.what() + '\n'};
+                }
+                connection.reply.reserve(reply.text.size() + 1);
+                connection.reply.push_back(reply.ok ? '0' : '1');
+                connection.reply += reply.text;
+                connection.replying = true;
+                if (sendReply(fd, connection)) {
+                    hangUp(fd);
+                }
+                else {
+                    watch(fd, EPOLLOUT, EPOLL_CTL_MOD);
+                }
+            }
+        }
+    }
+
+    return true;
+#else
+    (void) answer;
+    std::cerr << "--serve is only available on Linux, unable to listen on " << socketPath.string() << '\n';
+    return false;
+#endif
+}
+
+std::optional<QueryReply> sendQuery(const std::filesystem::path& socketPath, const std::vector<std::string>& args) {
+#if !defined(_WIN32)
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return std::nullopt;
+    }
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    std::string query;
+    auto putNumber = [&query](std::size_t value) {
+        const auto number = static_cast<std::uint32_t>(value);
+        query.append(reinterpret_cast<const char*>(&number), sizeof number);
+    };
+    putNumber(args.size());
+    for (const auto& arg : args) {
+        putNumber(arg.size());
+        query += arg;
+    }
+
+    std::string reply;
+    if (sendAll(fd, query.data(), query.size())) {
+        char buffer[64 * 1024];
+        ssize_t length{0};
+        while ((length = ::read(fd, buffer, sizeof buffer)) != 0) {
+            if (length < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                reply.clear();  // a reply cut short is no reply
+                break;
+            }
+            reply.append(buffer, static_cast<std::size_t>(length));
+        }
+    }
+    ::close(fd);
+
+    if (reply.empty() || (reply[0] != '0' && reply[0] != '1')) {
+        return std::nullopt;
+    }
+    return QueryReply{reply[0] == '0', reply.substr(1)};
+#else
+    (void) socketPath;
+    (void) args;
+    return std::nullopt;
+#endif
+}
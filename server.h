@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A small local query server on a Unix domain socket. A query is a list of
+// command-line arguments: their count, then each argument as its length followed
+// by its bytes, so that any argument can be sent, even an empty one. The count and
+// the lengths are 32-bit numbers in the byte order of the machine.
+// The reply is one status byte, '0' for a report or '1' for an error message,
+// followed by the text until the server closes the connection.
+
+// The answer to one query.
+struct QueryReply {
+    bool ok;           // `false` if the query was not valid
+    std::string text;  // the report, or the reason the query was not valid
+};
+
+using QueryHandler = std::function<QueryReply(const std::vector<std::string>& args)>;
+
+// Listens on `socketPath` and answers every query with `answer`, until the
+// process gets SIGINT or SIGTERM. Connections are served by one epoll loop, so
+// `answer` is never called concurrently, and an exception it throws is sent back
+// as an error reply. The socket file is removed whenever the server stops, and a
+// stale socket file left by a server that was killed is replaced. Returns `false`
+// and prints a message if the socket can't be set up or the event loop fails;
+// on systems without epoll it always does.
+bool serveQueries(const std::filesystem::path& socketPath, const QueryHandler& answer);
+
+// Sends the query `args` to the server listening on `socketPath` and returns its
+// reply, or `std::nullopt` if no server answers there.
+std::optional<QueryReply> sendQuery(const std::filesystem::path& socketPath, const std::vector<std::string>& args);
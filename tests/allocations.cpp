@@ -0,0 +1,111 @@
+// Counts the heap allocations made while events are added, to make sure that an
+// event costs a constant number of them, however many events there are.
+// Build and run from the top directory with
+//
+//     g++ -std=c++20 -o allocations tests/allocations.cpp event.cpp categories.cpp eventstore.cpp
+//     ./allocations
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../event.h"
+#include "../eventstore.h"
+
+namespace {
+
+std::size_t allocationCount{0};
+
+// Long enough that no standard library keeps it in the string object itself.
+constexpr std::string_view longDescription{"A description that is too long for the small string buffer"};
+
+const std::chrono::year_month_day someDate{std::chrono::year{2023}, std::chrono::month{5}, std::chrono::day{17}};
+
+// Returns the number of allocations made by `addEvents(count)`.
+template <typename F>
+std::size_t countAllocations(F addEvents, std::size_t count) {
+    const auto before = allocationCount;
+    addEvents(count);
+    return allocationCount - before;
+}
+
+// Each event in a vector of `Event`s owns its description,
+// which is built once and then moved into place.
+void addEvents(std::size_t count) {
+    std::vector<Event> events;
+    events.reserve(count);
+    for (std::size_t i{0}; i < count; i++) {
+        std::string description{longDescription};
+        events.emplace_back(someDate, "work", std::move(description));
+    }
+}
+
+// An `EventStore` copies the descriptions into its own buffer, so adding
+// events to a store with enough room reserved allocates nothing at all.
+void addStoreEvents(std::size_t count) {
+    EventStore events;
+    events.reserve(count, count * longDescription.size());
+    for (std::size_t i{0}; i < count; i++) {
+        events.add(someDate, "work", longDescription);
+    }
+}
+
+// Checks that adding 1000 events costs `expectedPerEvent` allocations more for each of the
+// 990 extra events than adding 10 events does, so that only the per-event cost grows.
+bool check(std::string_view name, void (*add)(std::size_t), std::size_t expectedPerEvent) {
+    add(1);  // so that the category is interned already
+    const auto few = countAllocations(add, 10);
+    const auto many = countAllocations(add, 1000);
+    const bool ok = many - few == 990 * expectedPerEvent;
+    std::cout << (ok ? "ok   " : "FAIL ") << name << ": " << few << " allocations for 10 events, "
+        << many << " for 1000 events\n";
+    return ok;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Over-aligned allocations count too.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocationCount++;
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align + (size == 0 ? align : 0))) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+int main() {
+    bool ok{true};
+    ok &= check("Event", addEvents, 1);
+    ok &= check("EventStore", addStoreEvents, 0);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,95 @@
+// Deletes events with `days delete` from an events file with many rows with bad dates,
+// and checks that the file is compacted once the deleted events are worth it, and only
+// then: compacting keeps the rows with bad dates, so they must not make every later
+// delete compact again. Compacting replaces the file, so it shows as a new inode.
+// Build days first, then build and run this from the top directory with
+//
+//     g++ -std=c++20 -o compaction tests/compaction.cpp
+//     ./compaction ./days
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int eventCount{100};
+constexpr int badDateRowCount{70};
+
+// With 100 events and 70 rows with bad dates, the 32nd delete is the first to leave
+// 64 dead rows (32 events and their tombstones) that are a quarter of the 202 rows.
+constexpr int deletesBeforeCompacting{32};
+
+std::string getDescription(int event) {
+    return "Event number " + std::to_string(event);
+}
+
+// Returns the inode of the file at `path`.
+ino_t getInode(const std::filesystem::path& path) {
+    struct stat status{};
+    ::stat(path.c_str(), &status);
+    return status.st_ino;
+}
+
+// Deletes the event number `event` with days. Returns `false` if days failed.
+bool deleteEvent(const std::string& days, int event) {
+    const std::string command{"'" + days + "' delete 2020-01-01 work '" + getDescription(event) + "' 2>/dev/null"};
+    return std::system(command.c_str()) == 0;
+}
+
+bool report(bool ok, std::string_view name) {
+    std::cout << (ok ? "ok   " : "FAIL ") << name << '\n';
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string days{std::filesystem::absolute(argc > 1 ? argv[1] : "./days").string()};
+
+    const auto home = std::filesystem::temp_directory_path() / ("days-compaction-test-" + std::to_string(::getpid()));
+    const auto eventsPath = home / ".days" / "events.csv";
+    std::filesystem::create_directories(eventsPath.parent_path());
+    {
+        std::ofstream events{eventsPath};
+        events << "date,category,description\n";
+        for (int i{0}; i < badDateRowCount; i++) {
+            events << "2020-13-01,typo,Bad date " << i << '\n';
+        }
+        for (int i{0}; i < eventCount; i++) {
+            events << "2020-01-01,work," << getDescription(i) << '\n';
+        }
+    }
+    ::setenv("HOME", home.c_str(), 1);
+
+    bool ok{true};
+    const auto original = getInode(eventsPath);
+    bool deleted{true};
+    for (int i{0}; i < deletesBeforeCompacting - 1; i++) {
+        deleted = deleted && deleteEvent(days, i);
+    }
+    ok &= report(deleted && getInode(eventsPath) == original,
+                 std::to_string(deletesBeforeCompacting - 1) + " deletes append to the file without compacting it");
+
+    deleted = deleteEvent(days, deletesBeforeCompacting - 1);
+    const auto compacted = getInode(eventsPath);
+    std::ifstream stream{eventsPath};
+    const std::string contents{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    ok &= report(deleted && compacted != original && contents.find("deleted:") == std::string::npos,
+                 "the next delete compacts it");
+    ok &= report(contents.find("Bad date " + std::to_string(badDateRowCount - 1) + '\n') != std::string::npos,
+                 "the rows with bad dates are still there");
+
+    deleted = deleteEvent(days, deletesBeforeCompacting) && deleteEvent(days, deletesBeforeCompacting + 1);
+    ok &= report(deleted && getInode(eventsPath) == compacted, "the deletes after that don't compact it again");
+
+    std::filesystem::remove_all(home);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,116 @@
+// Damages a cache file one byte at a time and checks that loading it never throws or
+// reads outside the file: it either gives events that can all be read, or a cache miss.
+// Build and run from the top directory with
+//
+//     g++ -std=c++20 -o eventcache tests/eventcache.cpp eventcache.cpp eventstore.cpp categories.cpp dates.cpp
+//     ./eventcache
+//
+// Adding -fsanitize=address to the build also catches reads just past the end of the file.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../eventcache.h"
+
+namespace {
+
+const CsvFingerprint someCsv{1234, 5678, 9012};
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream stream{path, std::ios::binary};
+    return std::string{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+}
+
+void writeFile(const std::filesystem::path& path, std::string_view contents) {
+    std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+    stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+// Loads the cache at `path` and reads every event in it.
+// Returns `false` if loading threw, which a damaged cache must never make it do.
+bool loadAndRead(const std::filesystem::path& path, std::size_t& loaded) {
+    try {
+        const auto cached = loadEventCache(path, someCsv);
+        if (!cached.has_value()) {
+            return true;
+        }
+        loaded++;
+        std::size_t bytes{0};
+        for (std::size_t i{0}; i < cached->events.size(); i++) {
+            bytes += cached->events.getCategory(i).size() + cached->events.getDescription(i).size();
+        }
+        return bytes > 0 || cached->events.size() == 0;
+    }
+    catch (const std::exception& e) {
+        std::cout << "loading threw: " << e.what() << '\n';
+        return false;
+    }
+}
+
+// Sets each byte of `original` in turn to a few values that make counts, ids and offsets
+// too big, saves it to `path` and loads it. Returns `false` if any load threw.
+bool checkDamaged(std::string_view name, const std::string& original, const std::filesystem::path& path) {
+    std::size_t loads{0};
+    std::size_t loaded{0};
+    bool ok{true};
+    for (std::size_t i{0}; i < original.size(); i++) {
+        for (const char value : {'\xff', '\x7f', '\x01'}) {
+            if (original[i] == value) {
+                continue;
+            }
+            auto damaged = original;
+            damaged[i] = value;
+            writeFile(path, damaged);
+            ok &= loadAndRead(path, loaded);
+            loads++;
+        }
+    }
+    std::cout << (ok ? "ok   " : "FAIL ") << name << ": " << loads << " damaged caches, "
+        << loaded << " of them still loaded\n";
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    const auto directory = std::filesystem::temp_directory_path() / "days-eventcache-test";
+    std::filesystem::create_directories(directory);
+    const auto path = directory / "events.bin";
+
+    EventStore events;
+    for (int i{0}; i < 20; i++) {
+        const std::chrono::year_month_day date{std::chrono::year{2000 + i}, std::chrono::month{5}, std::chrono::day{17}};
+        events.add(date, i % 2 == 0 ? "category-a" : "category-b", "description " + std::to_string(i));
+    }
+    if (!saveEventCache(path, EventCacheStamp{someCsv, 20, 0, 0}, events, {})) {
+        std::cout << "FAIL unable to save the cache\n";
+        return EXIT_FAILURE;
+    }
+    const auto original = readFile(path);
+
+    bool ok{true};
+    ok &= checkDamaged("same category ids", original, path);
+
+    // With a category name changed, the ids no longer match the ones in this
+    // process, so they are renumbered, and a bad id must be caught there too.
+    auto renamed = original;
+    const auto name = renamed.find("category-a");
+    if (name == std::string::npos) {
+        std::cout << "FAIL no category name in the cache\n";
+        return EXIT_FAILURE;
+    }
+    renamed[name] = 'C';
+    ok &= checkDamaged("renumbered category ids", renamed, path);
+
+    std::filesystem::remove_all(directory);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
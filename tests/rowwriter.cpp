@@ -0,0 +1,85 @@
+// Checks how rapidcsv::RowWriter quotes cells: by default like Document::Save always has,
+// and with QuoteRule::WhenNeeded only where needed, so that every cell reads back the same.
+// Build and run from the top directory with
+//
+//     g++ -std=c++20 -o rowwriter tests/rowwriter.cpp
+//     ./rowwriter
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../rapidcsv.h"
+
+namespace {
+
+// Cells with everything that may need quoting, some long enough to be checked 16 bytes at a time.
+const std::vector<std::string> cells{
+    "plain",
+    "two words",
+    "comma, inside",
+    "say \"hi\" now",
+    "q\"",
+    "line\nbreak",
+    "carriage\rreturn",
+    " padded ",
+    "",
+    "0123456789abcdefghijklmnop",
+    "0123456789abcdefghijklmnop,",
+    "0123456789abcdefghijklmnop\"",
+    "0123456789abcdefghijklmnop\n",
+};
+
+bool report(bool ok, std::string_view name, std::string_view written) {
+    std::cout << (ok ? "ok   " : "FAIL ") << name << '\n';
+    if (!ok) {
+        std::cout << "     wrote: " << written << '\n';
+    }
+    return ok;
+}
+
+// Returns `row` written by a RowWriter with `quoteRule`.
+std::string writeRow(const std::vector<std::string>& row, rapidcsv::RowWriter::QuoteRule quoteRule) {
+    std::ostringstream stream;
+    rapidcsv::RowWriter writer{stream, rapidcsv::SeparatorParams{',', false, false}};
+    writer.SetQuoteRule(quoteRule);
+    writer.WriteRow(row);
+    writer.Close();
+    return stream.str();
+}
+
+}  // namespace
+
+int main() {
+    bool ok{true};
+
+    // Cells with the separator or a space are quoted, nothing else is.
+    const std::string expected{
+        "plain,\"two words\",\"comma, inside\",\"say \"\"hi\"\" now\",q\",line\nbreak,carriage\rreturn,"
+        "\" padded \",,0123456789abcdefghijklmnop,\"0123456789abcdefghijklmnop,\","
+        "0123456789abcdefghijklmnop\",0123456789abcdefghijklmnop\n\n"};
+    const auto written = writeRow(cells, rapidcsv::RowWriter::QuoteRule::SeparatorOrSpace);
+    ok &= report(written == expected, "the default rule quotes cells with the separator or a space", written);
+
+    rapidcsv::Document document{"", rapidcsv::LabelParams{-1, -1}, rapidcsv::SeparatorParams{',', false, false}};
+    document.InsertRow(0, cells);
+    std::ostringstream saved;
+    document.Save(saved);
+    ok &= report(saved.str() == expected, "Document::Save quotes the same cells", saved.str());
+
+    // Only cells that would read back different are quoted, and all of them read back the same.
+    const auto needed = writeRow(cells, rapidcsv::RowWriter::QuoteRule::WhenNeeded);
+    ok &= report(needed.starts_with("plain,two words,\"comma, inside\",\"say \"\"hi\"\" now\",\"q\"\"\","),
+                 "QuoteRule::WhenNeeded leaves cells with spaces alone", needed);
+    std::istringstream stream{needed};
+    rapidcsv::RowReader reader{stream, static_cast<std::streamsize>(needed.size()),
+                               rapidcsv::SeparatorParams{',', false, false, true}};
+    std::vector<std::string> row;
+    ok &= report(reader.ReadRow(row) && row == cells && !reader.ReadRow(row),
+                 "QuoteRule::WhenNeeded reads back the same with quoted linebreaks", needed);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
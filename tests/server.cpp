@@ -0,0 +1,144 @@
+// Starts `days --serve` with a temporary home directory, so that it listens on a
+// temporary socket, and checks its replies against running days directly, its error
+// reply when the events file can't be read, and that the socket is removed on shutdown.
+// Build days first, then build and run this from the top directory with
+//
+//     g++ -std=c++20 -o server tests/server.cpp server.cpp
+//     ./server ./days
+//
+// Only runs on Linux, like `--serve` itself.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../server.h"
+
+namespace {
+
+const std::vector<std::vector<std::string>> queries{
+    {},
+    {"--within", "-10000"},
+    {"--category", "work"},
+    {"--category", ""},  // the events without a category
+    {"--category", "two words", "--by-category"},
+    {"--from", "2000-01-01", "--to", "2009-12-31", "--last", "2"},
+};
+
+// Returns `arg` quoted for the shell.
+std::string quote(std::string_view arg) {
+    std::string quoted{"'"};
+    for (const char c : arg) {
+        quoted += c == '\'' ? std::string{"'\\''"} : std::string{c};
+    }
+    return quoted + "'";
+}
+
+// Runs `days` with `args` and returns what it writes to standard output.
+std::string runDirectly(const std::string& days, const std::vector<std::string>& args) {
+    std::string command{quote(days) + " --no-cache"};
+    for (const auto& arg : args) {
+        command += ' ' + quote(arg);
+    }
+    std::string output;
+    if (FILE* pipe = ::popen(command.c_str(), "r")) {
+        char buffer[4096];
+        std::size_t length{0};
+        while ((length = std::fread(buffer, 1, sizeof buffer, pipe)) > 0) {
+            output.append(buffer, length);
+        }
+        ::pclose(pipe);
+    }
+    return output;
+}
+
+// Returns a readable form of `args` for the test report.
+std::string describe(const std::vector<std::string>& args) {
+    std::string text{"query"};
+    for (const auto& arg : args) {
+        text += ' ' + quote(arg);
+    }
+    return text;
+}
+
+bool report(bool ok, std::string_view name) {
+    std::cout << (ok ? "ok   " : "FAIL ") << name << '\n';
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string days{std::filesystem::absolute(argc > 1 ? argv[1] : "./days").string()};
+
+    const auto home = std::filesystem::temp_directory_path() / ("days-server-test-" + std::to_string(::getpid()));
+    const auto daysPath = home / ".days";
+    const auto eventsPath = daysPath / "events.csv";
+    const auto socketPath = daysPath / "days.sock";
+    std::filesystem::create_directories(daysPath);
+    std::ofstream{eventsPath} << "date,category,description\n"
+        << "2001-02-03,work,\"Started, finally\"\n"
+        << "2005-06-07,,No category\n"
+        << "1999-12-31,two words,Party\n"
+        << "2008-08-08,work,Olympics\n"
+        << "2003-03-03,,Another without a category\n";
+    ::setenv("HOME", home.c_str(), 1);
+    ::unsetenv("BIRTHDATE");
+
+    const pid_t server = ::fork();
+    if (server == 0) {
+        ::execl(days.c_str(), days.c_str(), "--serve", "--no-cache", static_cast<char*>(nullptr));
+        std::_Exit(127);
+    }
+
+    // Wait for the server to answer.
+    std::optional<QueryReply> reply;
+    for (int i{0}; i < 100 && !reply.has_value(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        reply = sendQuery(socketPath, {});
+    }
+
+    bool ok{true};
+    if (!report(reply.has_value(), "the server answers on " + socketPath.string())) {
+        ::kill(server, SIGKILL);
+        ::waitpid(server, nullptr, 0);
+        std::filesystem::remove_all(home);
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& args : queries) {
+        reply = sendQuery(socketPath, args);
+        const auto expected = runDirectly(days, args);
+        ok &= report(reply.has_value() && reply->ok && reply->text == expected,
+                     describe(args) + " gives the same report as running days (" + std::to_string(expected.size())
+                     + " bytes)");
+    }
+
+    reply = sendQuery(socketPath, {"--no-such-option"});
+    ok &= report(reply.has_value() && !reply->ok, "an unknown option gets an error reply");
+
+    std::filesystem::remove(eventsPath);
+    std::filesystem::create_directory(eventsPath);  // exists, but can't be read as a file
+    reply = sendQuery(socketPath, {});
+    ok &= report(reply.has_value() && !reply->ok && reply->text.starts_with("unable to read the events"),
+                 "an unreadable events file gets an error reply");
+
+    ::kill(server, SIGTERM);
+    ::waitpid(server, nullptr, 0);
+    ok &= report(!std::filesystem::exists(socketPath), "the socket is removed on shutdown");
+
+    std::filesystem::remove_all(home);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+#include "watcher.h"
+
+#include <algorithm>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <climits>  // for INT_MAX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// After a change, how long the file must be quiet before the change is reported,
+// and how long a burst of changes may go on before it is reported anyway.
+constexpr std::chrono::milliseconds settleTime{100};
+constexpr std::chrono::milliseconds maxSettleTime{1000};
+
+// How often the file is checked when it can't be watched with inotify.
+constexpr std::chrono::seconds pollInterval{1};
+
+#if defined(__linux__)
+// Returns the time from now until `deadline` as a poll() timeout.
+int millisecondsUntil(std::chrono::system_clock::time_point deadline) {
+    const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::system_clock::now());
+    return static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(left.count(), 0, INT_MAX));
+}
+#endif
+
+}  // namespace
+
+FileWatcher::FileWatcher(const std::filesystem::path& p) : path(p) {
+#if defined(__linux__)
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0) {
+        // Watch the directory, so that the file being replaced by a rename is seen as well.
+        const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path{"."};
+        const std::uint32_t mask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+        if (inotify_add_watch(inotifyFd, directory.c_str(), mask) < 0) {
+            ::close(inotifyFd);
+            inotifyFd = -1;
+        }
+    }
+#endif
+    statChanged();  // remember how the file is now
+}
+
+FileWatcher::~FileWatcher() {
+#if defined(__linux__)
+    if (inotifyFd >= 0) {
+        ::close(inotifyFd);
+    }
+#endif
+}
+
+bool FileWatcher::wait(std::chrono::system_clock::time_point deadline) {
+    if (inotifyFd >= 0) {
+        return waitForInotify(deadline);
+    }
+    return waitByPolling(deadline);
+}
+
+bool FileWatcher::waitForInotify(std::chrono::system_clock::time_point deadline) {
+#if defined(__linux__)
+    const auto name = path.filename().string();
+    std::chrono::system_clock::time_point firstChange{};
+    bool changed{false};
+    while (true) {
+        int timeout = millisecondsUntil(deadline);
+        if (changed) {
+            timeout = std::min(static_cast<int>(settleTime.count()), millisecondsUntil(firstChange + maxSettleTime));
+        }
+
+        pollfd ready{inotifyFd, POLLIN, 0};
+        const auto count = ::poll(&ready, 1, timeout);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return changed;  // quiet again, or the deadline has passed
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length{0};
+        while ((length = ::read(inotifyFd, buffer, sizeof buffer)) > 0) {
+            for (ssize_t offset{0}; offset < length; ) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_IGNORED) {
+                    // The directory is gone, so there is nothing left to watch with inotify.
+                    ::close(inotifyFd);
+                    inotifyFd = -1;
+                    return true;
+                }
+                if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && name == event->name)) {
+                    if (!changed) {
+                        firstChange = std::chrono::system_clock::now();
+                    }
+                    changed = true;
+                }
+            }
+        }
+        if (!changed && std::chrono::system_clock::now() >= deadline) {
+            return false;
+        }
+    }
+#else
+    return waitByPolling(deadline);
+#endif
+}
+
+bool FileWatcher::waitByPolling(std::chrono::system_clock::time_point deadline) {
+    while (!statChanged()) {
+        const auto now = std::chrono::system_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::system_clock::duration>(pollInterval, deadline - now));
+    }
+    return true;
+}
+
+bool FileWatcher::statChanged() {
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        size = static_cast<std::uintmax_t>(-1);  // missing files count as a size of their own
+    }
+    auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        modified = std::filesystem::file_time_type{};
+    }
+
+    const bool changed = size != lastSize || modified != lastModified;
+    lastSize = size;
+    lastModified = modified;
+    return changed;
+}
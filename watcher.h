@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+// Waits for a file to change. On Linux this uses inotify on the file's directory, so that
+// the file being replaced or recreated is noticed too. Elsewhere, or if inotify is not
+// available, the file's size and modification time are checked once a second.
+class FileWatcher {
+public:
+    explicit FileWatcher(const std::filesystem::path& path);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Waits until the file may have changed or until `deadline`, whichever comes first.
+    // Returns `true` if the file may have changed. A burst of changes, like a program
+    // writing a file in pieces, is reported once when it has been quiet for a moment.
+    bool wait(std::chrono::system_clock::time_point deadline);
+
+private:
+    bool waitForInotify(std::chrono::system_clock::time_point deadline);
+    bool waitByPolling(std::chrono::system_clock::time_point deadline);
+
+    // Returns `true` if the size or the modification time of the file differs from the last call.
+    bool statChanged();
+
+    std::filesystem::path path;
+    int inotifyFd{-1};
+    std::uintmax_t lastSize{0};
+    std::filesystem::file_time_type lastModified{};
+};